@@ -0,0 +1,305 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Command line tools around the plugin's filter path, for CI and QA
+    without a host.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "../../Source/GoldenRender.h"
+#include "../../Source/OfflineRender.h"
+#include "../../Source/SpectrumRasteriser.h"
+
+#include <iostream>
+
+namespace
+{
+    void runGolden(const juce::ArgumentList& args)
+    {
+        args.checkMinNumArguments(2);
+
+        GoldenRender::Options options;
+        options.goldenDirectory = args[1].resolveAsFile();
+        options.recordMissing = args.containsOption("--record-missing");
+        options.recordAll = args.containsOption("--record-all");
+
+        auto& tolerance = options.tolerance;
+
+        if (args.containsOption("--bit-exact"))
+        {
+            tolerance.mode = GoldenRender::Tolerance::Mode::BitExact;
+        }
+        else if (args.containsOption("--max-abs"))
+        {
+            tolerance.mode = GoldenRender::Tolerance::Mode::MaxAbs;
+            tolerance.maxAbsError = args.getValueForOption("--max-abs").getDoubleValue();
+        }
+        else if (args.containsOption("--rms"))
+        {
+            tolerance.mode = GoldenRender::Tolerance::Mode::Rms;
+            tolerance.rmsError = args.getValueForOption("--rms").getDoubleValue();
+        }
+        else if (args.containsOption("--margin"))
+        {
+            tolerance.recordedMargin = args.getValueForOption("--margin").getDoubleValue();
+        }
+
+        if (!options.recordMissing && !options.recordAll && !options.goldenDirectory.isDirectory())
+            juce::ConsoleApplication::fail("No golden files in " + options.goldenDirectory.getFullPathName());
+
+        const auto results = GoldenRender::run(options);
+        std::cout << GoldenRender::formatReport(results, tolerance) << std::flush;
+
+        const auto seconds = args.containsOption("--time") ? args.getValueForOption("--time").getDoubleValue() : 10.0;
+
+        if (seconds > 0.0)
+            std::cout << "\n" << GoldenRender::formatThroughput(GoldenRender::measureThroughput(seconds)) << std::flush;
+
+        if (!GoldenRender::allPassed(results))
+            juce::ConsoleApplication::fail("Golden render FAILED");
+    }
+
+    //==============================================================================
+    // "<freq>:<a>:<b>" from --name=..., or false when the option isn't given
+    bool getBandOption(const juce::ArgumentList& args, const juce::String& option, int minFields, juce::StringArray& fields)
+    {
+        if (!args.containsOption(option))
+            return false;
+
+        fields = juce::StringArray::fromTokens(args.getValueForOption(option), ":", "");
+
+        if (fields.size() < minFields)
+            juce::ConsoleApplication::fail("Expected at least " + juce::String(minFields) + " values for " + option);
+
+        return true;
+    }
+
+    Slope parseSlope(const juce::String& text)
+    {
+        const auto dbPerOct = text.getIntValue();
+
+        if (dbPerOct != 12 && dbPerOct != 24 && dbPerOct != 36 && dbPerOct != 48)
+            juce::ConsoleApplication::fail("Slopes are 12, 24, 36 or 48 dB/Oct, not " + text);
+
+        return (Slope)(dbPerOct / 12 - 1);
+    }
+
+    // every band starts bypassed; the options turn on the ones they set
+    ChainSettings parseChainSettings(const juce::ArgumentList& args)
+    {
+        ChainSettings settings;
+
+        settings.lowCutFreq = 20.f;
+        settings.highCutFreq = 20000.f;
+        settings.lowPeakFreq = 100.f;
+        settings.lowMidPeakFreq = 500.f;
+        settings.highMidPeakFreq = 2000.f;
+        settings.highPeakFreq = 8000.f;
+
+        settings.lowCutBypassed = settings.lowPeakBypassed = settings.lowMidPeakBypassed = true;
+        settings.highMidPeakBypassed = settings.highPeakBypassed = settings.highCutBypassed = true;
+
+        juce::StringArray fields;
+
+        auto cut = [&](const juce::String& option, float& freq, Slope& slope, bool& bypassed)
+        {
+            if (!getBandOption(args, option, 1, fields))
+                return;
+
+            freq = fields[0].getFloatValue();
+            slope = fields.size() > 1 ? parseSlope(fields[1]) : Slope_12;
+            bypassed = false;
+        };
+
+        auto peak = [&](const juce::String& option, float& freq, float& gainInDecibels, float& quality, bool& bypassed)
+        {
+            if (!getBandOption(args, option, 2, fields))
+                return;
+
+            freq = fields[0].getFloatValue();
+            gainInDecibels = fields[1].getFloatValue();
+            quality = fields.size() > 2 ? fields[2].getFloatValue() : 1.f;
+            bypassed = false;
+        };
+
+        cut("--low-cut", settings.lowCutFreq, settings.lowCutSlope, settings.lowCutBypassed);
+        cut("--high-cut", settings.highCutFreq, settings.highCutSlope, settings.highCutBypassed);
+
+        peak("--low-peak", settings.lowPeakFreq, settings.lowPeakGainInDecibels, settings.lowPeakQuality, settings.lowPeakBypassed);
+        peak("--low-mid-peak", settings.lowMidPeakFreq, settings.lowMidPeakGainInDecibels, settings.lowMidPeakQuality, settings.lowMidPeakBypassed);
+        peak("--high-mid-peak", settings.highMidPeakFreq, settings.highMidPeakGainInDecibels, settings.highMidPeakQuality, settings.highMidPeakBypassed);
+        peak("--high-peak", settings.highPeakFreq, settings.highPeakGainInDecibels, settings.highPeakQuality, settings.highPeakBypassed);
+
+        return settings;
+    }
+
+    // mono files are rendered as dual mono, since the bands' routing works on a stereo pair
+    std::unique_ptr<juce::AudioFormatReader> openReader(juce::AudioFormatManager& formats, const juce::File& file)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+
+        if (reader == nullptr)
+            juce::ConsoleApplication::fail("Can't read " + file.getFullPathName());
+
+        if (reader->numChannels < 1 || reader->numChannels > 2)
+            juce::ConsoleApplication::fail("Only mono and stereo files can be rendered");
+
+        return reader;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> openWriter(juce::AudioFormatManager& formats, const juce::File& file,
+                                                        double sampleRate, int bitsPerSample)
+    {
+        auto* format = formats.findFormatForFileExtension(file.getFileExtension());
+
+        if (format == nullptr || !format->canDoStereo())
+            juce::ConsoleApplication::fail("Can't write " + file.getFileExtension() + " files");
+
+        if (!format->getPossibleBitDepths().contains(bitsPerSample))
+            bitsPerSample = format->getPossibleBitDepths().getLast();
+
+        file.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(file);
+
+        if (!stream->openedOk())
+            juce::ConsoleApplication::fail("Can't open " + file.getFullPathName());
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate, 2, bitsPerSample, {}, 0));
+
+        if (writer == nullptr)
+            juce::ConsoleApplication::fail("Can't write " + file.getFullPathName() + " at " + juce::String(bitsPerSample) + " bits");
+
+        stream.release();   // the writer owns it now
+        return writer;
+    }
+
+    void runRender(const juce::ArgumentList& args)
+    {
+        args.checkMinNumArguments(3);
+
+        const auto inputFile = args[1].resolveAsFile();
+        const auto outputFile = args[2].resolveAsFile();
+
+        if (inputFile == outputFile)
+            juce::ConsoleApplication::fail("The output would overwrite the input");
+
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        auto reader = openReader(formats, inputFile);
+        OfflineRender::Input input(*reader);
+
+        const auto chainSettings = parseChainSettings(args);
+
+        if (args.containsOption("--scaling"))
+        {
+            const auto maxThreads = juce::jmax(1, args.getValueForOption("--scaling").getIntValue());
+
+            std::cout << "threads  ms        speed-up  max abs error (" << juce::SystemStats::getNumCpus() << " cores)" << std::endl;
+
+            for (const auto& result : OfflineRender::measureScaling(input, chainSettings, maxThreads))
+            {
+                std::cout << juce::String(result.numThreads).paddedRight(' ', 9)
+                          << juce::String(result.milliseconds, 1).paddedRight(' ', 10)
+                          << juce::String(result.speedUp, 2).paddedRight(' ', 10)
+                          << juce::String(result.maxAbsError, 9) << std::endl;
+            }
+        }
+
+        const auto bitsPerSample = reader->usesFloatingPointData ? 32 : (int)reader->bitsPerSample;
+        auto writer = openWriter(formats, outputFile, input.getSampleRate(), bitsPerSample);
+
+        OfflineRender::Options options;
+        options.numThreads = args.getValueForOption("--threads").getIntValue();
+
+        const auto report = OfflineRender::render(input, chainSettings, options,
+                                                  [&writer](const juce::AudioBuffer<float>& buffer, int start, int numSamples)
+                                                  {
+                                                      return writer->writeFromAudioSampleBuffer(buffer, start, numSamples);
+                                                  });
+
+        if (!report.completed)
+            juce::ConsoleApplication::fail("Writing " + outputFile.getFullPathName() + " failed");
+
+        std::cout << inputFile.getFileName() << " -> " << outputFile.getFileName() << ": "
+                  << input.getNumSamples() << " samples at " << input.getSampleRate() << " Hz, "
+                  << report.numSegments << " segments on " << report.numThreads << " threads, "
+                  << report.warmUpSamples << " warm-up samples, "
+                  << juce::String((double)report.bufferBytes / (1024.0 * 1024.0), 1) << " MB buffered, "
+                  << juce::String(report.milliseconds, 1) << " ms" << std::endl;
+    }
+
+    //==============================================================================
+    void runRaster(const juce::ArgumentList& args)
+    {
+        auto getIntOption = [&args](const juce::String& option, int defaultValue)
+        {
+            return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : defaultValue;
+        };
+
+        // about the editor's analysis area at its default size
+        const auto width = juce::jmax(2, getIntOption("--width", 760));
+        const auto height = juce::jmax(2, getIntOption("--height", 200));
+        const auto numFrames = juce::jmax(1, getIntOption("--frames", 500));
+
+        std::cout << width << " x " << height << " logical pixels, " << numFrames << " frames of two curves, software renderer" << std::endl
+                  << "scale  raster ms  strokePath ms  speed-up" << std::endl;
+
+        for (auto scale : { 1.f, 2.f })
+        {
+            const auto result = SpectrumRasteriser::benchmark(width, height, scale, numFrames);
+
+            std::cout << (juce::String(scale, 0) + "x").paddedRight(' ', 7)
+                      << juce::String(result.rasterMsPerFrame, 3).paddedRight(' ', 11)
+                      << juce::String(result.strokePathMsPerFrame, 3).paddedRight(' ', 15)
+                      << juce::String(result.strokePathMsPerFrame / juce::jmax(1.0e-6, result.rasterMsPerFrame), 2) << std::endl;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ConsoleApplication app;
+
+    app.addHelpCommand("--help|-h", "SpectrumEQ console", true);
+
+    app.addCommand({ "golden",
+                     "golden <directory> [--record-missing|--record-all] [--bit-exact|--max-abs=<x>|--rms=<x>|--margin=<x>] [--time=<s>]",
+                     "Checks the filter path against the golden files in <directory>",
+                     "Renders every configuration through FilterEngine and compares it with the golden files, "
+                     "exiting with 1 when one differs or is missing. By default each golden may differ by what "
+                     "it did when recorded plus --margin (5e-4); --bit-exact, --max-abs and --rms apply one "
+                     "threshold to all of them instead. --record-missing writes the missing goldens and "
+                     "--record-all rewrites every one, from the baseline MonoChain where it can express the "
+                     "configuration and from this build otherwise; commit them only after listening to what "
+                     "changed. Then times the engine and the baseline over --time seconds of noise (10, 0 skips).",
+                     runGolden });
+
+    app.addCommand({ "render",
+                     "render <input> <output> [--low-cut=<Hz>[:<dB/Oct>]] [--high-cut=...] [--low-peak=<Hz>:<dB>[:<Q>]] "
+                     "[--low-mid-peak=...] [--high-mid-peak=...] [--high-peak=...] [--threads=<n>] [--scaling=<n>]",
+                     "Renders an audio file through the panel's bands",
+                     "Streams <input> (mono or stereo, any format JUCE reads) through the bands the options "
+                     "turn on, in segments split over --threads threads (default one per core), into <output> in "
+                     "the format of its extension; memory stays the same whatever the file's length. Bands "
+                     "without an option stay bypassed; the dynamic peaks and auto "
+                     "gain are not applied. --scaling=<n> first times the serial render and 1 to n threads on the "
+                     "input and prints the speed-up and the largest difference from the serial render.",
+                     runRender });
+
+    app.addCommand({ "raster",
+                     "raster [--width=<px>] [--height=<px>] [--frames=<n>]",
+                     "Times the analyzer's rasteriser against stroking its curves as paths",
+                     "Draws two random-walk curves per frame, --frames times (500), into a --width by --height "
+                     "(760 x 200) area at 1x and 2x with JUCE's software renderer: once through "
+                     "SpectrumRasteriser and composited, once as paths with Graphics::strokePath. Prints the "
+                     "milliseconds per frame of each.",
+                     runRaster });
+
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,300 @@
+/*
+  ==============================================================================
+
+    AnalyzerFrameExport.cpp
+
+  ==============================================================================
+*/
+
+#include "AnalyzerFrameExport.h"
+#include "MultiResolutionAnalyzer.h"
+
+// the counters live in memory that other processes map, so they must not need a lock
+static_assert(std::atomic<juce::uint64>::is_always_lock_free, "frame counters must be lock free");
+
+namespace
+{
+    template <typename T>
+    void writeField(char* base, int offset, T value)
+    {
+        std::memcpy(base + offset, &value, sizeof(T));
+    }
+}
+
+AnalyzerFrameExport::~AnalyzerFrameExport()
+{
+    // unmapped first: some systems won't delete a file that is still mapped
+    mapping.reset();
+    file.deleteFile();
+}
+
+std::unique_ptr<AnalyzerFrameExport> AnalyzerFrameExport::create(const juce::File& file, int maxFFTOrder, int channel, int capacity)
+{
+    const auto maxBins = (1 << maxFFTOrder) / 2;
+
+    // frames stay 8 byte aligned, so every sequence is an aligned atomic
+    const auto frameStride = (frameHeaderSize + maxBins * (int)sizeof(float) + 7) & ~7;
+    const auto fileSize = (size_t)headerSize + (size_t)capacity * (size_t)frameStride;
+
+    {
+        // sized up front: a mapping can't grow the file
+        juce::MemoryBlock zeros(fileSize, true);
+
+        if (!file.getParentDirectory().createDirectory() || !file.replaceWithData(zeros.getData(), zeros.getSize()))
+            return nullptr;
+    }
+
+    std::unique_ptr<AnalyzerFrameExport> frameExport(new AnalyzerFrameExport());
+
+    frameExport->file = file;
+    frameExport->mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite, false);
+
+    if (frameExport->mapping->getData() == nullptr || frameExport->mapping->getSize() < fileSize)
+        return nullptr;
+
+    frameExport->base = static_cast<char*>(frameExport->mapping->getData());
+    frameExport->capacity = capacity;
+    frameExport->frameStride = frameStride;
+    frameExport->maxBins = maxBins;
+
+    auto* base = frameExport->base;
+
+    std::memcpy(base, "SEQFRAME", 8);
+    writeField<juce::uint32>(base, 8, 3);
+    writeField<juce::uint32>(base, 12, headerSize);
+    writeField<juce::uint32>(base, 16, (juce::uint32)capacity);
+    writeField<juce::uint32>(base, 20, (juce::uint32)frameStride);
+    writeField<juce::uint32>(base, 32, (juce::uint32)channel);
+    writeField<juce::uint32>(base, 48, (juce::uint32)maxBins);
+
+    // the rest of the file is still zero: no frames, every sequence says "never written"
+    return frameExport;
+}
+
+std::atomic<juce::uint64>& AnalyzerFrameExport::getFramesWritten() const
+{
+    return *reinterpret_cast<std::atomic<juce::uint64>*>(base + 40);
+}
+
+std::atomic<juce::uint64>& AnalyzerFrameExport::getSequence(int slot) const
+{
+    return *reinterpret_cast<std::atomic<juce::uint64>*>(base + headerSize + slot * frameStride);
+}
+
+void AnalyzerFrameExport::write(const float* decibels, int fftOrder, Mode mode, juce::uint64 audioPosition, double audioSeconds, double sampleRate)
+{
+    const auto numBins = (1 << fftOrder) / 2;
+    jassert(numBins <= maxBins);
+
+    const auto slot = (int)(framesWritten % (juce::uint64)capacity);
+    auto* frame = base + headerSize + slot * frameStride;
+    auto& sequence = getSequence(slot);
+
+    sequence.store(2 * framesWritten + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    writeField(frame, 8, audioPosition);
+    writeField(frame, 16, audioSeconds);
+    writeField(frame, 24, sampleRate);
+    writeField<juce::uint32>(frame, 32, (juce::uint32)fftOrder);
+    writeField<juce::uint32>(frame, 36, (juce::uint32)mode);
+    writeField<juce::uint32>(frame, 40, (juce::uint32)numBins);
+    std::memcpy(frame + frameHeaderSize, decibels, sizeof(float) * (size_t)juce::jmin(numBins, maxBins));
+
+    sequence.store(2 * framesWritten + 2, std::memory_order_release);
+
+    writeField<juce::uint32>(base, 24, (juce::uint32)fftOrder);
+    writeField<juce::uint32>(base, 28, (juce::uint32)numBins);
+    writeField<juce::uint32>(base, 36, (juce::uint32)mode);
+
+    ++framesWritten;
+    getFramesWritten().store(framesWritten, std::memory_order_release);
+}
+
+//==============================================================================
+AnalyzerFrameExportTap::AnalyzerFrameExportTap() :
+    juce::Thread("Analyzer frame export"),
+    hops((size_t)numHops),
+    fftData((size_t)(2 * fftSize), 0.f)
+{
+    for (auto& window : windows)
+        window.assign((size_t)fftSize, 0.f);
+
+    resources = FFTResourceCache::acquire(fftOrder, juce::dsp::WindowingFunction<float>::blackmanHarris);
+}
+
+std::unique_ptr<AnalyzerFrameExportTap> AnalyzerFrameExportTap::createFromEnvironment()
+{
+    const auto directory = juce::SystemStats::getEnvironmentVariable("SPECTRUMEQ_FRAME_EXPORT_DIR", {});
+
+    if (directory.isEmpty() || !juce::File::isAbsolutePath(directory))
+        return nullptr;
+
+    // the tap's address keeps the instances of one process apart, the tag keeps processes apart
+    static const auto processTag = juce::String::toHexString(juce::Random::getSystemRandom().nextInt64());
+
+    std::unique_ptr<AnalyzerFrameExportTap> tap(new AnalyzerFrameExportTap());
+    const auto instance = juce::String::toHexString((juce::pointer_sized_int)tap.get());
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        const auto file = juce::File(directory).getChildFile("SpectrumEQ-" + processTag + "-" + instance
+                                                             + (channel == 0 ? "-R" : "-L") + ".frames");
+
+        // room for the stitched multi-resolution spectrum, the longest the analyzer makes
+        tap->exports[(size_t)channel] = AnalyzerFrameExport::create(file, fftOrder + MultiResolutionAnalyzer::numDecimations, channel);
+
+        if (tap->exports[(size_t)channel] == nullptr)
+        {
+            juce::Logger::writeToLog("SpectrumEQ: couldn't create " + file.getFullPathName());
+            return nullptr;
+        }
+    }
+
+    juce::Logger::writeToLog("SpectrumEQ: exporting analyzer frames to " + tap->exports[0]->getFile().getFullPathName()
+                             + " and " + tap->exports[1]->getFile().getFileName());
+
+    tap->startThread();
+    return tap;
+}
+
+AnalyzerFrameExportTap::~AnalyzerFrameExportTap()
+{
+    stopThread(2000);
+}
+
+void AnalyzerFrameExportTap::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    // a part-filled hop belongs to the stream that just stopped
+    pendingSamples = 0;
+}
+
+void AnalyzerFrameExportTap::push(const juce::AudioBuffer<float>& buffer)
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto lastChannel = buffer.getNumChannels() - 1;
+
+    if (lastChannel < 0)
+        return;
+
+    for (int start = 0; start < numSamples;)
+    {
+        const auto count = juce::jmin(hopSize - pendingSamples, numSamples - start);
+
+        for (int channel = 0; channel < 2; ++channel)
+            std::copy_n(buffer.getReadPointer(juce::jmin(channel, lastChannel), start), count,
+                        pending.samples[(size_t)channel].begin() + pendingSamples);
+
+        start += count;
+        pendingSamples += count;
+        audioPosition += (juce::uint64)count;
+        audioSeconds += count / sampleRate;
+
+        if (pendingSamples < hopSize)
+            break;
+
+        pendingSamples = 0;
+        pending.endPosition = audioPosition;
+        pending.endSeconds = audioSeconds;
+        pending.sampleRate = sampleRate;
+
+        // a full ring drops this hop; the reader sees the jump in the positions
+        const auto scope = hopFifo.write(1);
+
+        if (scope.blockSize1 > 0)
+            hops[(size_t)scope.startIndex1] = pending;
+    }
+}
+
+void AnalyzerFrameExportTap::run()
+{
+    while (!threadShouldExit())
+    {
+        if (hopFifo.getNumReady() == 0)
+        {
+            wait(5);
+            continue;
+        }
+
+        const auto scope = hopFifo.read(1);
+
+        if (scope.blockSize1 > 0)
+            analyse(hops[(size_t)scope.startIndex1]);
+    }
+}
+
+void AnalyzerFrameExportTap::analyse(const Hop& hop)
+{
+    const auto newMode = requestedMode.load();
+    const auto modeChanged = newMode != mode;
+    mode = newMode;
+
+    const auto isContiguous = hop.endPosition == lastEndPosition + hopSize && lastEndPosition != 0 && !modeChanged;
+    lastEndPosition = hop.endPosition;
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        if (mode == Mode::Single)
+        {
+            // after a dropped hop the window would join two pieces of audio that weren't adjacent
+            if (!isContiguous)
+                std::fill(windows[(size_t)channel].begin(), windows[(size_t)channel].end(), 0.f);
+
+            analyseSingle(channel, hop);
+        }
+        else
+        {
+            auto& analyzer = multiResolutionAnalyzers[(size_t)channel];
+
+            if (analyzer == nullptr)
+                analyzer = std::make_unique<MultiResolutionAnalyzer>();
+
+            // prepare() starts every level from silence
+            if (!isContiguous)
+            {
+                analyzer->setNormalisation(mode == Mode::MultiResolutionNoise ? MultiResolutionAnalyzer::Normalisation::Noise
+                                                                              : MultiResolutionAnalyzer::Normalisation::Tone);
+                analyzer->prepare(fftOrder);
+            }
+
+            analyseMultiResolution(channel, hop);
+        }
+    }
+}
+
+void AnalyzerFrameExportTap::analyseSingle(int channel, const Hop& hop)
+{
+    const auto numBins = fftSize / 2;
+    auto& window = windows[(size_t)channel];
+
+    std::copy(window.begin() + hopSize, window.end(), window.begin());
+    std::copy(hop.samples[(size_t)channel].begin(), hop.samples[(size_t)channel].end(), window.end() - hopSize);
+
+    // as FFTDataGenerator does for the analyzer
+    std::fill(fftData.begin(), fftData.end(), 0.f);
+    std::copy(window.begin(), window.end(), fftData.begin());
+
+    juce::FloatVectorOperations::multiply(fftData.data(), resources->window.data(), fftSize);
+    resources->fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        const auto v = fftData[(size_t)i];
+        fftData[(size_t)i] = juce::Decibels::gainToDecibels(std::isfinite(v) ? v / (float)numBins : 0.f, -48.f);
+    }
+
+    exports[(size_t)channel]->write(fftData.data(), fftOrder, Mode::Single, hop.endPosition, hop.endSeconds, hop.sampleRate);
+}
+
+void AnalyzerFrameExportTap::analyseMultiResolution(int channel, const Hop& hop)
+{
+    auto& analyzer = *multiResolutionAnalyzers[(size_t)channel];
+
+    // one stitched spectrum per push, as the editor's PathProducer gets them
+    analyzer.pushSamples(hop.samples[(size_t)channel].data(), hopSize, -48.f);
+
+    while (auto* spectrum = analyzer.getFFTData())
+        exports[(size_t)channel]->write(spectrum->data(), analyzer.getFFTOrder(), mode, hop.endPosition, hop.endSeconds, hop.sampleRate);
+}
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    AnalyzerFrameExport.h
+
+    Writes analyzer frames into memory-mapped ring files, so QA tools can
+    follow the spectra of an instance's output with or without an editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FFTResourceCache.h"
+
+#include <atomic>
+#include <memory>
+
+struct MultiResolutionAnalyzer;
+
+/*
+ file layout, little endian, offsets in bytes:
+
+   header, 64 bytes
+      0  char[8]   magic "SEQFRAME"
+      8  uint32    version, 3
+     12  uint32    header size, 64
+     16  uint32    capacity, frames in the ring
+     20  uint32    frame stride
+     24  uint32    FFT order of the latest frame, 0 before the first
+     28  uint32    bins of the latest frame, 2^order / 2
+     32  uint32    channel, as enum Channel (0 right, 1 left)
+     36  uint32    mode of the latest frame, as AnalyzerFrameExport::Mode
+     40  uint64    frames written. updated after each frame is complete
+     48  uint32    most bins a frame can hold
+     52  uint32    reserved
+     56  uint64    reserved
+
+   frame n lives in slot n % capacity, at header size + slot * stride
+      0  uint64    sequence: 2n + 1 while it is being written, 2n + 2 once complete
+      8  uint64    audio position: samples the instance had processed when the frame's window ended
+     16  double    audio time of the same point, in seconds (each block counted at its own sample rate)
+     24  double    sample rate
+     32  uint32    FFT order: the size of the FFT the bins come from, or stand in for
+     36  uint32    mode (0 single FFT, 1 multi-resolution tone, 2 multi-resolution noise)
+     40  uint32    bins, 2^order / 2
+     44  uint32    reserved
+     48  float[]   bins, in dB with the analyzer's floor (-48) for silence
+
+ the mode can change while the file is being written, so a reader goes by each
+ frame's own order, mode and bins; the header's copies are for a glance at the file.
+ the writer never waits for anyone. a reader maps the file, loads 'frames written'
+ and reads slots back from there, straight out of the mapping; a frame is only valid
+ if its sequence is 2n + 2 both before and after its bins were read. frames that
+ were dropped leave a jump in the audio position.
+
+ the file is deleted when the writer is destroyed.
+ */
+struct AnalyzerFrameExport
+{
+    static constexpr int defaultCapacity = 512;
+    static constexpr int headerSize = 64;
+    static constexpr int frameHeaderSize = 48;
+
+    // the analyzer's, as the editor's resolution box offers them
+    enum class Mode
+    {
+        Single,
+        MultiResolutionTone,
+        MultiResolutionNoise
+    };
+
+    ~AnalyzerFrameExport();
+
+    // nullptr when the file can't be created or mapped. every slot has room for the bins of maxFFTOrder
+    static std::unique_ptr<AnalyzerFrameExport> create(const juce::File& file, int maxFFTOrder, int channel, int capacity = defaultCapacity);
+
+    // decibels holds 2^fftOrder / 2 bins, for an order up to the one this was created for
+    void write(const float* decibels, int fftOrder, Mode mode, juce::uint64 audioPosition, double audioSeconds, double sampleRate);
+
+    const juce::File& getFile() const { return file; }
+
+private:
+    AnalyzerFrameExport() = default;
+
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+
+    char* base = nullptr;
+    int capacity = 0, frameStride = 0, maxBins = 0;
+    juce::uint64 framesWritten = 0;
+
+    std::atomic<juce::uint64>& getFramesWritten() const;
+    std::atomic<juce::uint64>& getSequence(int slot) const;
+};
+
+/*
+ the processor's analyzer tap for the export. off unless the environment variable
+ SPECTRUMEQ_FRAME_EXPORT_DIR names a directory; each instance then writes
+ SpectrumEQ-<process>-<instance>-<L|R>.frames there for as long as it exists,
+ whether an editor is open or not. while it's off the processor holds a null pointer
+ and the only cost is testing it.
+
+ the audio thread copies its output in hops of hopSize samples into a lock-free ring;
+ a background thread runs the analyzer over them, as the editor's analyzer is set up,
+ and writes a frame per hop and channel. a hop that finds the ring full is dropped,
+ not waited for.
+
+ the mode follows the editor's resolution box through setMode(); without an editor
+ it's the box's default, a single 2048 point FFT. in either case each frame is what
+ the editor's analyzer would have drawn from the same audio: blackman-harris, dB
+ with a -48 dB floor, and for multi-resolution the stitched spectrum, see
+ MultiResolutionAnalyzer.
+ */
+struct AnalyzerFrameExportTap : private juce::Thread
+{
+    using Mode = AnalyzerFrameExport::Mode;
+
+    // the order FFTDataGenerator and every level of MultiResolutionAnalyzer run at
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = 512;
+    static constexpr int numHops = 64;      // about 0.7 s at 48 kHz before hops are dropped
+
+    // nullptr unless SPECTRUMEQ_FRAME_EXPORT_DIR is set, or if the files can't be created
+    static std::unique_ptr<AnalyzerFrameExportTap> createFromEnvironment();
+
+    ~AnalyzerFrameExportTap() override;
+
+    // while the audio thread isn't running. the files stay mapped and the audio position keeps counting
+    void prepare(double sampleRate);
+
+    // audio thread
+    void push(const juce::AudioBuffer<float>& buffer);
+
+    // any thread. the analysis thread picks it up from its next hop, starting the windows from silence
+    void setMode(Mode newMode) { requestedMode.store(newMode); }
+
+private:
+    AnalyzerFrameExportTap();
+
+    struct Hop
+    {
+        std::array<std::array<float, hopSize>, 2> samples;
+        juce::uint64 endPosition = 0;
+        double endSeconds = 0.0;
+        double sampleRate = 0.0;
+    };
+
+    // [0] right, [1] left, as enum Channel
+    std::array<std::unique_ptr<AnalyzerFrameExport>, 2> exports;
+
+    // audio thread
+    Hop pending;
+    int pendingSamples = 0;
+    juce::uint64 audioPosition = 0;
+    double audioSeconds = 0.0;
+    double sampleRate = 44100.0;
+
+    std::vector<Hop> hops;
+    juce::AbstractFifo hopFifo{ numHops };
+
+    std::atomic<Mode> requestedMode{ Mode::Single };
+
+    // analysis thread
+    Mode mode = Mode::Single;
+    std::array<std::vector<float>, 2> windows;
+    std::vector<float> fftData;
+    juce::uint64 lastEndPosition = 0;
+
+    FFTResourceCache::Handle resources;
+
+    // [0] right, [1] left, used in the multi-resolution modes
+    std::array<std::unique_ptr<MultiResolutionAnalyzer>, 2> multiResolutionAnalyzers;
+
+    void run() override;
+    void analyse(const Hop& hop);
+    void analyseSingle(int channel, const Hop& hop);
+    void analyseMultiResolution(int channel, const Hop& hop);
+};
@@ -0,0 +1,181 @@
+/*
+  ==============================================================================
+
+    AutoGain.cpp
+
+  ==============================================================================
+*/
+
+#include "AutoGain.h"
+
+void AutoGain::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    dryCopy.setSize(2, maximumBlockSize, false, true, false);
+    capturedSamples = 0;
+
+    // BS.1770 K-weighting re-derived for this sample rate: a high shelf, then the RLB high-pass
+    {
+        const auto K = std::tan(juce::MathConstants<double>::pi * 1681.974450955533 / sampleRate);
+        const auto Q = 0.7071752369554196;
+        const auto Vh = std::pow(10.0, 3.999843853973347 / 20.0);
+        const auto Vb = std::pow(Vh, 0.4996667741545416);
+        const auto a0 = 1.0 + K / Q + K * K;
+
+        shelf = { (float)((Vh + Vb * K / Q + K * K) / a0),
+                  (float)(2.0 * (K * K - Vh) / a0),
+                  (float)((Vh - Vb * K / Q + K * K) / a0),
+                  (float)(2.0 * (K * K - 1.0) / a0),
+                  (float)((1.0 - K / Q + K * K) / a0) };
+    }
+
+    {
+        const auto K = std::tan(juce::MathConstants<double>::pi * 38.13547087602444 / sampleRate);
+        const auto Q = 0.5003270373238773;
+        const auto a0 = 1.0 + K / Q + K * K;
+
+        highPass = { 1.f, -2.f, 1.f,
+                     (float)(2.0 * (K * K - 1.0) / a0),
+                     (float)((1.0 - K / Q + K * K) / a0) };
+    }
+
+    hopLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+
+    makeUpGain.reset(sampleRate, 1.0);
+
+    reset();
+}
+
+void AutoGain::reset()
+{
+    resetMeasurement();
+
+    makeUpGain.setCurrentAndTargetValue(1.f);
+    gainInDecibels.store(0.f);
+}
+
+void AutoGain::resetMeasurement()
+{
+    shelfS1.fill(0.f);
+    shelfS2.fill(0.f);
+    highPassS1.fill(0.f);
+    highPassS2.fill(0.f);
+    hopSum.fill(0.f);
+
+    for (auto& hop : hopMeanSquares)
+        hop.fill(0.f);
+
+    hopPosition = 0;
+    hopIndex = 0;
+    hopsFilled = 0;
+}
+
+void AutoGain::captureInput(const juce::AudioBuffer<float>& buffer)
+{
+    // hosts may exceed the block size they announced: the excess just isn't metered
+    jassert(buffer.getNumSamples() <= dryCopy.getNumSamples());
+    capturedSamples = juce::jmin(buffer.getNumSamples(), dryCopy.getNumSamples());
+
+    const auto numChannels = buffer.getNumChannels();
+
+    for (int ch = 0; ch < 2; ++ch)
+        dryCopy.copyFrom(ch, 0, buffer, juce::jmin(ch, numChannels - 1), 0, capturedSamples);
+}
+
+void AutoGain::process(juce::AudioBuffer<float>& buffer, bool frozen)
+{
+    // stop a ramp that's under way, not just the next target update
+    if (frozen && !isFrozen)
+        makeUpGain.setCurrentAndTargetValue(makeUpGain.getCurrentValue());
+
+    isFrozen = frozen;
+
+    const auto numChannels = buffer.getNumChannels();
+    const float* channels[numLanes] = { dryCopy.getReadPointer(0),
+                                        dryCopy.getReadPointer(1),
+                                        buffer.getReadPointer(0),
+                                        buffer.getReadPointer(juce::jmin(1, numChannels - 1)) };
+
+    measure(channels, juce::jmin(capturedSamples, buffer.getNumSamples()));
+
+    makeUpGain.applyGain(buffer, buffer.getNumSamples());
+    gainInDecibels.store(juce::Decibels::gainToDecibels(makeUpGain.getCurrentValue()));
+}
+
+void AutoGain::fadeOut(juce::AudioBuffer<float>& buffer)
+{
+    // so freezing again after the next enable holds whatever this left
+    isFrozen = false;
+    makeUpGain.setTargetValue(1.f);
+
+    if (makeUpGain.isSmoothing())
+        makeUpGain.applyGain(buffer, buffer.getNumSamples());
+
+    gainInDecibels.store(juce::Decibels::gainToDecibels(makeUpGain.getCurrentValue()));
+}
+
+void AutoGain::measure(const float* const* channels, int numSamples)
+{
+    const auto [sb0, sb1, sb2, sa1, sa2] = shelf;
+    const auto [hb0, hb1, hb2, ha1, ha2] = highPass;
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        for (int i = 0; i < numLanes; ++i)
+        {
+            const auto x = channels[i][n];
+
+            const auto s = sb0 * x + shelfS1[i];
+            shelfS1[i] = sb1 * x - sa1 * s + shelfS2[i];
+            shelfS2[i] = sb2 * x - sa2 * s;
+
+            const auto k = hb0 * s + highPassS1[i];
+            highPassS1[i] = hb1 * s - ha1 * k + highPassS2[i];
+            highPassS2[i] = hb2 * s - ha2 * k;
+
+            hopSum[i] += k * k;
+        }
+
+        if (++hopPosition == hopLength)
+            finishHop();
+    }
+}
+
+void AutoGain::finishHop()
+{
+    auto& hop = hopMeanSquares[(size_t)hopIndex];
+
+    for (int i = 0; i < numLanes; ++i)
+    {
+        hop[i] = hopSum[i] / (float)hopLength;
+        hopSum[i] = 0.f;
+    }
+
+    hopPosition = 0;
+    hopIndex = (hopIndex + 1) % hopsPerWindow;
+    hopsFilled = juce::jmin(hopsFilled + 1, hopsPerWindow);
+
+    // summed fresh every hop rather than kept as a running total, so rounding can't drift
+    Lanes window{};
+    for (int h = 0; h < hopsFilled; ++h)
+    {
+        for (int i = 0; i < numLanes; ++i)
+            window[i] += hopMeanSquares[(size_t)h][i];
+    }
+
+    auto toLUFS = [this](float left, float right)
+    {
+        return -0.691f + 10.f * std::log10(juce::jmax((left + right) / (float)hopsFilled, 1.0e-12f));
+    };
+
+    const auto inputLoudness = toLUFS(window[0], window[1]);
+    const auto outputLoudness = toLUFS(window[2], window[3]);
+
+    // silence on either side says nothing about the EQ's level change
+    if (isFrozen || inputLoudness < absoluteGateInLUFS || outputLoudness < absoluteGateInLUFS)
+        return;
+
+    const auto target = juce::jlimit(-maxGainInDecibels, maxGainInDecibels, inputLoudness - outputLoudness);
+    makeUpGain.setTargetValue(juce::Decibels::decibelsToGain(target));
+}
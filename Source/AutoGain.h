@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    AutoGain.h
+
+    Make-up gain that keeps the output as loud as the input, from short-term
+    K-weighted loudness measured ITU-R BS.1770 style.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+
+/*
+ input left/right and output left/right are four lanes sharing the K-weighting
+ coefficients, stepped together so the per-sample work (two biquads and a square)
+ vectorises. loudness itself is only evaluated once per 100 ms hop, over the last
+ 30 hops (the 3 s short-term window).
+ */
+struct AutoGain
+{
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    // forgets the measured loudness and drops the make-up gain to unity at once
+    void reset();
+
+    // forgets the measured loudness only, for when metering restarts. the gain carries on from where it is
+    void resetMeasurement();
+
+    // before the EQ: keeps a copy of the dry signal for the input lanes
+    void captureInput(const juce::AudioBuffer<float>& buffer);
+
+    // after the EQ: meters the dry copy against buffer, then applies the smoothed make-up gain to buffer.
+    // while frozen the gain holds where it is
+    void process(juce::AudioBuffer<float>& buffer, bool frozen);
+
+    // instead of process() while auto gain is off: ramps whatever make-up gain is left back to unity
+    void fadeOut(juce::AudioBuffer<float>& buffer);
+
+    // safe to read from any thread
+    float getGainInDecibels() const { return gainInDecibels.load(); }
+
+private:
+    static constexpr int numLanes = 4;
+    static constexpr int hopsPerWindow = 30;
+    static constexpr float maxGainInDecibels = 24.f;
+    static constexpr float absoluteGateInLUFS = -70.f;
+
+    using Lanes = std::array<float, numLanes>;
+    using Section = std::array<float, 5>;   // { b0, b1, b2, a1, a2 }
+
+    double sampleRate = 44100.0;
+
+    juce::AudioBuffer<float> dryCopy;
+    int capturedSamples = 0;
+
+    Section shelf{}, highPass{};
+    alignas(16) Lanes shelfS1{}, shelfS2{}, highPassS1{}, highPassS2{};
+    alignas(16) Lanes hopSum{};
+
+    std::array<Lanes, hopsPerWindow> hopMeanSquares{};
+    int hopLength = 4410, hopPosition = 0, hopIndex = 0, hopsFilled = 0;
+
+    bool isFrozen = false;
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> makeUpGain;
+    std::atomic<float> gainInDecibels{ 0.f };
+
+    void measure(const float* const* channels, int numSamples);
+    void finishHop();
+};
@@ -0,0 +1,284 @@
+/*
+  ==============================================================================
+
+    BiquadBank.cpp
+
+  ==============================================================================
+*/
+
+#include "BiquadBank.h"
+#include "CoefficientCache.h"
+
+bool BandSpec::operator==(const BandSpec& other) const
+{
+    return type == other.type
+        && freq == other.freq
+        && quality == other.quality
+        && gainInDecibels == other.gainInDecibels
+        && order == other.order;
+}
+
+//==============================================================================
+// the same formulas as IIR::Coefficients, evaluated in double and normalised by a0
+namespace
+{
+    using Section = BiquadBank::Section;
+
+    Section normalise(double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        auto a0Inverse = 1.0 / a0;
+        return { (float)(b0 * a0Inverse), (float)(b1 * a0Inverse), (float)(b2 * a0Inverse),
+                 (float)(a1 * a0Inverse), (float)(a2 * a0Inverse) };
+    }
+
+    double getOmega(double sampleRate, float freq)
+    {
+        auto nyquistSafe = juce::jlimit(2.0, sampleRate * 0.499, (double)freq);
+        return juce::MathConstants<double>::twoPi * nyquistSafe / sampleRate;
+    }
+
+    Section makePeak(double sampleRate, float freq, float quality, float gainInDecibels)
+    {
+        auto A = std::pow(10.0, (double)gainInDecibels / 40.0);
+        auto omega = getOmega(sampleRate, freq);
+        auto alpha = std::sin(omega) / ((double)quality * 2.0);
+        auto c2 = -2.0 * std::cos(omega);
+
+        return normalise(1.0 + alpha * A, c2, 1.0 - alpha * A, 1.0 + alpha / A, c2, 1.0 - alpha / A);
+    }
+
+    Section makeShelf(double sampleRate, float freq, float quality, float gainInDecibels, bool high)
+    {
+        auto A = std::pow(10.0, (double)gainInDecibels / 40.0);
+        auto aminus1 = A - 1.0;
+        auto aplus1 = A + 1.0;
+        auto omega = getOmega(sampleRate, freq);
+        auto coso = std::cos(omega);
+        auto beta = std::sin(omega) * std::sqrt(A) / (double)quality;
+        auto aminus1TimesCoso = aminus1 * coso;
+
+        if (high)
+            return normalise(A * (aplus1 + aminus1TimesCoso + beta),
+                             A * -2.0 * (aminus1 + aplus1 * coso),
+                             A * (aplus1 + aminus1TimesCoso - beta),
+                             aplus1 - aminus1TimesCoso + beta,
+                             2.0 * (aminus1 - aplus1 * coso),
+                             aplus1 - aminus1TimesCoso - beta);
+
+        return normalise(A * (aplus1 - aminus1TimesCoso + beta),
+                         A * 2.0 * (aminus1 - aplus1 * coso),
+                         A * (aplus1 - aminus1TimesCoso - beta),
+                         aplus1 + aminus1TimesCoso + beta,
+                         -2.0 * (aminus1 + aplus1 * coso),
+                         aplus1 + aminus1TimesCoso - beta);
+    }
+
+    Section makeNotch(double sampleRate, float freq, float quality)
+    {
+        auto n = 1.0 / std::tan(getOmega(sampleRate, freq) * 0.5);
+        auto n2 = n * n;
+        auto invQ = 1.0 / (double)quality;
+
+        return normalise(1.0 + n2, 2.0 * (1.0 - n2), 1.0 + n2, 1.0 + n * invQ + n2, 2.0 * (1.0 - n2), 1.0 - n * invQ + n2);
+    }
+
+    Section makeBandPass(double sampleRate, float freq, float quality)
+    {
+        auto n = 1.0 / std::tan(getOmega(sampleRate, freq) * 0.5);
+        auto n2 = n * n;
+        auto invQ = 1.0 / (double)quality;
+
+        return normalise(n * invQ, 0.0, -n * invQ, 1.0 + n * invQ + n2, 2.0 * (1.0 - n2), 1.0 - n * invQ + n2);
+    }
+
+    Section makeLowPass(double sampleRate, float freq, double quality)
+    {
+        auto n = 1.0 / std::tan(getOmega(sampleRate, freq) * 0.5);
+        auto n2 = n * n;
+
+        return normalise(1.0, 2.0, 1.0, 1.0 + n / quality + n2, 2.0 * (1.0 - n2), 1.0 - n / quality + n2);
+    }
+
+    Section makeHighPass(double sampleRate, float freq, double quality)
+    {
+        auto n = std::tan(getOmega(sampleRate, freq) * 0.5);
+        auto n2 = n * n;
+
+        return normalise(1.0, -2.0, 1.0, 1.0 + n / quality + n2, 2.0 * (n2 - 1.0), 1.0 - n / quality + n2);
+    }
+}
+
+int BiquadBank::design(const BandSpec& spec, double sampleRate, Section* sections)
+{
+    switch (spec.type)
+    {
+        case BandType::Peak:
+            sections[0] = makePeak(sampleRate, spec.freq, spec.quality, spec.gainInDecibels);
+            return 1;
+
+        case BandType::LowShelf:
+        case BandType::HighShelf:
+            sections[0] = makeShelf(sampleRate, spec.freq, spec.quality, spec.gainInDecibels, spec.type == BandType::HighShelf);
+            return 1;
+
+        case BandType::Notch:
+            sections[0] = makeNotch(sampleRate, spec.freq, spec.quality);
+            return 1;
+
+        case BandType::BandPass:
+            sections[0] = makeBandPass(sampleRate, spec.freq, spec.quality);
+            return 1;
+
+        case BandType::Tilt:
+            sections[0] = makeShelf(sampleRate, spec.freq, spec.quality, -0.5f * spec.gainInDecibels, false);
+            sections[1] = makeShelf(sampleRate, spec.freq, spec.quality, 0.5f * spec.gainInDecibels, true);
+            return 2;
+
+        case BandType::LowCut:
+        case BandType::HighCut:
+        {
+            // butterworth, as FilterDesign::designIIR*HighOrderButterworthMethod for even orders
+            auto order = juce::jlimit(2, 2 * maxSectionsPerBand, spec.order & ~1);
+
+            for (int i = 0; i < order / 2; ++i)
+            {
+                auto Q = 1.0 / (2.0 * std::cos((2.0 * i + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+                sections[i] = spec.type == BandType::LowCut ? makeHighPass(sampleRate, spec.freq, Q)
+                                                            : makeLowPass(sampleRate, spec.freq, Q);
+            }
+
+            return order / 2;
+        }
+    }
+
+    jassertfalse;
+    return 0;
+}
+
+//==============================================================================
+void BiquadBank::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    upToDate.fill(false);
+    sectionCounts.fill(0);
+
+    reset();
+}
+
+void BiquadBank::reset()
+{
+    for (auto& state : s1)
+        state.fill(0.f);
+
+    for (auto& state : s2)
+        state.fill(0.f);
+}
+
+void BiquadBank::setNumBands(int newNumBands)
+{
+    jassert(juce::isPositiveAndNotGreaterThan(newNumBands, maxBands));
+    numBands = juce::jlimit(0, maxBands, newNumBands);
+}
+
+void BiquadBank::setBand(int band, const BandSpec& spec)
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+
+    if (upToDate[band] && specs[band] == spec)
+        return;
+
+    std::array<Section, maxSectionsPerBand> sections;
+    auto numSections = coefficientCache != nullptr ? coefficientCache->getOrDesign(spec, sampleRate, sections.data())
+                                                   : design(spec, sampleRate, sections.data());
+
+    setBand(band, spec, sections.data(), numSections);
+}
+
+void BiquadBank::setBand(int band, const BandSpec& spec, const Section* sections, int numSections)
+{
+    writeSections(band, sections, numSections);
+
+    specs[band] = spec;
+    upToDate[band] = true;
+}
+
+void BiquadBank::overrideSections(int band, const Section* sections, int numSections)
+{
+    writeSections(band, sections, numSections);
+    upToDate[band] = false;
+}
+
+void BiquadBank::writeSections(int band, const Section* sections, int numSections)
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+    jassert(juce::isPositiveAndNotGreaterThan(numSections, maxSectionsPerBand));
+
+    const auto first = band * maxSectionsPerBand;
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        const auto index = first + i;
+        const auto& section = sections[i];
+
+        b0[index] = section[0];
+        b1[index] = section[1];
+        b2[index] = section[2];
+        a1[index] = section[3];
+        a2[index] = section[4];
+
+        // sections that were idle start from silence rather than whatever they last held
+        if (i >= sectionCounts[band])
+        {
+            for (int ch = 0; ch < maxChannels; ++ch)
+            {
+                s1[ch][index] = 0.f;
+                s2[ch][index] = 0.f;
+            }
+        }
+    }
+
+    sectionCounts[band] = numSections;
+}
+
+void BiquadBank::process(float* samples, int channel, int numSamples, juce::uint32 bandMask)
+{
+    jassert(juce::isPositiveAndBelow(channel, maxChannels));
+
+    auto& state1 = s1[channel];
+    auto& state2 = s2[channel];
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        if ((bandMask & (1u << band)) == 0)
+            continue;
+
+        const auto first = band * maxSectionsPerBand;
+        const auto last = first + sectionCounts[band];
+
+        for (int s = first; s < last; ++s)
+        {
+            const auto c0 = b0[s], c1 = b1[s], c2 = b2[s], c3 = a1[s], c4 = a2[s];
+            auto z1 = state1[s];
+            auto z2 = state2[s];
+
+            // transposed direct form II, as IIR::Filter
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const auto x = samples[n];
+                const auto y = c0 * x + z1;
+
+                z1 = c1 * x - c3 * y + z2;
+                z2 = c2 * x - c4 * y;
+
+                samples[n] = y;
+            }
+
+            juce::dsp::util::snapToZero(z1);
+            juce::dsp::util::snapToZero(z2);
+
+            state1[s] = z1;
+            state2[s] = z2;
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    BiquadBank.h
+
+    A runtime list of up to 24 bands, each designed into one or more
+    second-order sections, stored and processed as structure-of-arrays.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+
+struct CoefficientCache;
+
+enum class BandType
+{
+    Peak,
+    LowShelf,
+    HighShelf,
+    Notch,
+    BandPass,
+    Tilt,       // low shelf down and high shelf up by half the gain each, pivoting at freq
+    LowCut,
+    HighCut
+};
+
+struct BandSpec
+{
+    BandType type{ BandType::Peak };
+    float freq{ 1000.f }, quality{ 0.71f }, gainInDecibels{ 0 };
+    int order{ 2 };     // cuts only: 2, 4, 6 or 8 (12 to 48 dB/Oct)
+
+    bool operator==(const BandSpec& other) const;
+    bool operator!=(const BandSpec& other) const { return !(*this == other); }
+};
+
+/*
+ every band owns maxSectionsPerBand slots in the coefficient and state arrays, so
+ nothing moves when a band changes type or slope. processing walks the bands in a
+ mask and runs each of their sections over the whole block: one tight loop per
+ section, no virtual calls and no pointers to follow.
+ sections are { b0, b1, b2, a1, a2 }, normalised by a0.
+ */
+struct BiquadBank
+{
+    static constexpr int maxBands = 24;
+    static constexpr int maxSectionsPerBand = 4;
+    static constexpr int maxSections = maxBands * maxSectionsPerBand;
+    static constexpr int maxChannels = 2;
+
+    using Section = std::array<float, 5>;
+
+    // returns the number of sections written, at most maxSectionsPerBand
+    static int design(const BandSpec& spec, double sampleRate, Section* sections);
+
+    void prepare(double sampleRate);
+    void reset();
+
+    void setNumBands(int newNumBands);
+    int getNumBands() const { return numBands; }
+
+    // setBand() looks designs up here first. the cache has to outlive the bank, nullptr designs every time
+    void setCoefficientCache(CoefficientCache* newCache) { coefficientCache = newCache; }
+
+    // audio thread. redesigns only when the spec changed or the sections were overridden
+    void setBand(int band, const BandSpec& spec);
+
+    // adopts sections that were designed elsewhere for this spec (preset recall)
+    void setBand(int band, const BandSpec& spec, const Section* sections, int numSections);
+
+    // replaces the sections without a spec (dynamic gain); the next setBand() redesigns
+    void overrideSections(int band, const Section* sections, int numSections);
+
+    // runs the sections of every band set in bandMask over one channel, in band order
+    void process(float* samples, int channel, int numSamples, juce::uint32 bandMask);
+
+private:
+    double sampleRate = 44100.0;
+    int numBands = 0;
+
+    CoefficientCache* coefficientCache = nullptr;
+
+    std::array<BandSpec, maxBands> specs;
+    std::array<bool, maxBands> upToDate{};
+    std::array<int, maxBands> sectionCounts{};
+
+    alignas(16) std::array<float, maxSections> b0{}, b1{}, b2{}, a1{}, a2{};
+    alignas(16) std::array<std::array<float, maxSections>, maxChannels> s1{}, s2{};
+
+    void writeSections(int band, const Section* sections, int numSections);
+};
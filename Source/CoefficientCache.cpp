@@ -0,0 +1,316 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+namespace
+{
+    // the value in whole steps, if it is (to float precision) a whole number of them
+    bool toSteps(float value, float step, int& steps)
+    {
+        auto scaled = (double)value / (double)step;
+        steps = (int)std::round(scaled);
+        return std::abs(scaled - steps) < 1.0e-3;
+    }
+
+    bool isCached(BandType type)
+    {
+        return type == BandType::Peak || type == BandType::LowCut || type == BandType::HighCut;
+    }
+
+    /*
+     | 63 valid | 57..38 sample rate (Hz) | 37..29 Q steps | 28..21 gain steps + 128 | 20..6 freq (Hz) | 5..3 order / 2 | 2..0 type |
+     */
+    juce::uint64 packKey(BandType type, int order, int freqSteps, int gainSteps, int qualitySteps, int sampleRate)
+    {
+        return (juce::uint64(1) << 63)
+             | (juce::uint64(sampleRate) << 38)
+             | (juce::uint64(qualitySteps) << 29)
+             | (juce::uint64(gainSteps + 128) << 21)
+             | (juce::uint64(freqSteps) << 6)
+             | (juce::uint64(order / 2) << 3)
+             | juce::uint64(type);
+    }
+
+    // the spec exactly on the grid, which is what every entry is designed from
+    BandSpec unpackKey(juce::uint64 key, double& sampleRate)
+    {
+        BandSpec spec;
+        spec.type = (BandType)(key & 7);
+        spec.order = 2 * (int)((key >> 3) & 7);
+        spec.freq = CoefficientCache::freqStep * (float)((key >> 6) & 0x7fff);
+        spec.gainInDecibels = CoefficientCache::gainStep * (float)((int)((key >> 21) & 0xff) - 128);
+        spec.quality = CoefficientCache::qualityStep * (float)((key >> 29) & 0x1ff);
+
+        sampleRate = (double)((key >> 38) & 0xfffff);
+        return spec;
+    }
+}
+
+CoefficientCache::CoefficientCache() :
+    juce::Thread("Coefficient prewarm"),
+    slots(std::make_unique<Slot[]>(numSlots))
+{
+}
+
+CoefficientCache::~CoefficientCache()
+{
+    stopThread(2000);
+}
+
+bool CoefficientCache::makeKey(const BandSpec& spec, double sampleRate, juce::uint64& key)
+{
+    if (!isCached(spec.type))
+        return false;
+
+    int rate = 0, freqSteps = 0, gainSteps = 0, qualitySteps = 0;
+
+    if (!toSteps((float)sampleRate, 1.f, rate) || !juce::isPositiveAndBelow(rate, 1 << 20))
+        return false;
+
+    if (!toSteps(spec.freq, freqStep, freqSteps) || !juce::isPositiveAndBelow(freqSteps, 1 << 15))
+        return false;
+
+    // the cuts don't use gain or Q, so they don't split the key either
+    if (spec.type == BandType::Peak)
+    {
+        if (!toSteps(spec.gainInDecibels, gainStep, gainSteps) || !juce::isPositiveAndBelow(gainSteps + 128, 256))
+            return false;
+
+        if (!toSteps(spec.quality, qualityStep, qualitySteps) || !juce::isPositiveAndBelow(qualitySteps - 1, 511))
+            return false;
+    }
+    else if (spec.order < 2 || spec.order > 2 * BiquadBank::maxSectionsPerBand || (spec.order & 1) != 0)
+    {
+        return false;
+    }
+
+    key = packKey(spec.type, spec.type == BandType::Peak ? 2 : spec.order, freqSteps, gainSteps, qualitySteps, rate);
+    return true;
+}
+
+int CoefficientCache::getFirstSlot(juce::uint64 key)
+{
+    static_assert(numSlots == 1 << 12, "the shift below takes the top 12 bits");
+
+    // fibonacci hashing, the top bits are the well mixed ones
+    return (int)((key * 0x9E3779B97F4A7C15ull) >> (64 - 12));
+}
+
+int CoefficientCache::lookup(juce::uint64 key, Section* sections) const
+{
+    const auto first = getFirstSlot(key);
+
+    for (int probe = 0; probe < maxProbes; ++probe)
+    {
+        const auto& slot = slots[(size_t)((first + probe) & (numSlots - 1))];
+
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+
+        if ((sequence & 1) != 0 || slot.key.load(std::memory_order_relaxed) != key)
+            continue;
+
+        const auto numSections = slot.numSections.load(std::memory_order_relaxed);
+
+        for (int s = 0; s < numSections; ++s)
+        {
+            for (int c = 0; c < 5; ++c)
+                sections[s][(size_t)c] = slot.coefficients[(size_t)(s * 5 + c)].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // rewritten while we copied: whatever we have may be half of something else
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+            break;
+
+        return numSections;
+    }
+
+    return 0;
+}
+
+void CoefficientCache::insert(juce::uint64 key, const Section* sections, int numSections)
+{
+    jassert(juce::isPositiveAndNotGreaterThan(numSections, BiquadBank::maxSectionsPerBand));
+
+    const auto first = getFirstSlot(key);
+
+    // the key's own slot if it's already there, else the first free one, else evict the home slot
+    auto* target = &slots[(size_t)first];
+
+    for (int probe = 0; probe < maxProbes; ++probe)
+    {
+        auto& slot = slots[(size_t)((first + probe) & (numSlots - 1))];
+        const auto slotKey = slot.key.load(std::memory_order_relaxed);
+
+        if (slotKey == key || slotKey == 0)
+        {
+            target = &slot;
+            break;
+        }
+    }
+
+    auto sequence = target->sequence.load(std::memory_order_relaxed);
+
+    if ((sequence & 1) != 0 || !target->sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+        return;
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    target->key.store(key, std::memory_order_relaxed);
+    target->numSections.store(numSections, std::memory_order_relaxed);
+
+    for (int s = 0; s < numSections; ++s)
+    {
+        for (int c = 0; c < 5; ++c)
+            target->coefficients[(size_t)(s * 5 + c)].store(sections[s][(size_t)c], std::memory_order_relaxed);
+    }
+
+    target->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+int CoefficientCache::getOrDesign(const BandSpec& spec, double sampleRate, Section* sections)
+{
+    juce::uint64 key = 0;
+
+    if (!makeKey(spec, sampleRate, key))
+        return BiquadBank::design(spec, sampleRate, sections);
+
+    if (auto numSections = lookup(key, sections))
+    {
+        numHits.fetch_add(1, std::memory_order_relaxed);
+        return numSections;
+    }
+
+    numMisses.fetch_add(1, std::memory_order_relaxed);
+
+    // unpacked before the call: the rate it fills in mustn't be read as an argument alongside it
+    double gridSampleRate = 0.0;
+    const auto grid = unpackKey(key, gridSampleRate);
+    auto numSections = BiquadBank::design(grid, gridSampleRate, sections);
+
+    insert(key, sections, numSections);
+    return numSections;
+}
+
+//==============================================================================
+void CoefficientCache::prewarm(const std::vector<BandSpec>& centres, double sampleRate)
+{
+    {
+        const juce::ScopedLock sl(requestLock);
+        requestedCentres = centres;
+        requestedSampleRate = sampleRate;
+        requestPending = true;
+    }
+
+    if (!isThreadRunning())
+        startThread();
+
+    notify();
+}
+
+void CoefficientCache::run()
+{
+    while (!threadShouldExit())
+    {
+        std::vector<BandSpec> centres;
+        double sampleRate = 0.0;
+
+        {
+            const juce::ScopedLock sl(requestLock);
+
+            if (requestPending)
+            {
+                centres.swap(requestedCentres);
+                sampleRate = requestedSampleRate;
+                requestPending = false;
+            }
+        }
+
+        if (centres.empty())
+        {
+            wait(-1);
+            continue;
+        }
+
+        for (const auto& centre : centres)
+        {
+            if (threadShouldExit())
+                return;
+
+            prewarmAround(centre, sampleRate);
+        }
+    }
+}
+
+void CoefficientCache::prewarmAround(const BandSpec& centre, double sampleRate)
+{
+    juce::uint64 key = 0;
+
+    if (!makeKey(centre, sampleRate, key))
+        return;
+
+    double gridSampleRate = 0.0;
+    const auto grid = unpackKey(key, gridSampleRate);
+
+    // one parameter at a time: that's how a knob or an automation lane moves
+    for (int i = -freqRadius; i <= freqRadius; ++i)
+    {
+        auto spec = grid;
+        spec.freq += freqStep * (float)i;
+
+        if (grid.type == BandType::Peak)
+        {
+            prewarmSpec(spec, gridSampleRate);
+            continue;
+        }
+
+        for (int order = 2; order <= 2 * BiquadBank::maxSectionsPerBand; order += 2)
+        {
+            spec.order = order;
+            prewarmSpec(spec, gridSampleRate);
+        }
+    }
+
+    if (grid.type != BandType::Peak)
+        return;
+
+    for (int i = -gainRadius; i <= gainRadius; ++i)
+    {
+        auto spec = grid;
+        spec.gainInDecibels += gainStep * (float)i;
+        prewarmSpec(spec, gridSampleRate);
+    }
+
+    for (int i = -qualityRadius; i <= qualityRadius; ++i)
+    {
+        auto spec = grid;
+        spec.quality += qualityStep * (float)i;
+        prewarmSpec(spec, gridSampleRate);
+    }
+}
+
+void CoefficientCache::prewarmSpec(const BandSpec& spec, double sampleRate)
+{
+    juce::uint64 key = 0;
+
+    if (!makeKey(spec, sampleRate, key))
+        return;
+
+    std::array<Section, BiquadBank::maxSectionsPerBand> sections;
+
+    if (lookup(key, sections.data()) > 0)
+        return;
+
+    double gridSampleRate = 0.0;
+    const auto grid = unpackKey(key, gridSampleRate);
+    auto numSections = BiquadBank::design(grid, gridSampleRate, sections.data());
+
+    insert(key, sections.data(), numSections);
+}
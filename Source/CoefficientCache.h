@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+
+    Designed sections for peak and Butterworth cut bands, memoised on the
+    parameters' quantisation steps and the sample rate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadBank.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+/*
+ freq moves in 1 Hz steps, gain in 0.5 dB and Q in 0.05, and a cut has four slopes,
+ so at a fixed sample rate there are only so many distinct designs and automation
+ keeps revisiting them. a spec that sits on that grid packs into a 64-bit key.
+
+ the table is fixed-size and open-addressed over a short probe. every slot is a
+ seqlock: readers never wait and retry nothing, a torn read is just a miss. a writer
+ claims a slot by making its sequence odd and gives up if someone else has it, so
+ the audio thread can insert its own misses without ever blocking.
+
+ prewarm() designs the neighbourhood of some specs on a background thread, so a
+ sweep away from where the session opened finds its coefficients already there.
+ */
+struct CoefficientCache : private juce::Thread
+{
+    using Section = BiquadBank::Section;
+
+    static constexpr int numSlots = 4096;     // power of two
+    static constexpr int maxProbes = 4;
+
+    static constexpr float freqStep = 1.f;
+    static constexpr float gainStep = 0.5f;
+    static constexpr float qualityStep = 0.05f;
+
+    CoefficientCache();
+    ~CoefficientCache() override;
+
+    // false for types the cache doesn't hold and for specs that are off the grid
+    static bool makeKey(const BandSpec& spec, double sampleRate, juce::uint64& key);
+
+    // any thread, never blocks. returns the number of sections, 0 on a miss
+    int lookup(juce::uint64 key, Section* sections) const;
+
+    // any thread, never blocks. skipped when the slot is being written by someone else
+    void insert(juce::uint64 key, const Section* sections, int numSections);
+
+    // what BiquadBank calls instead of design(): the cached sections, or designed and stored
+    int getOrDesign(const BandSpec& spec, double sampleRate, Section* sections);
+
+    // designs the specs' quantised neighbours in the background. replaces any request still pending
+    void prewarm(const std::vector<BandSpec>& centres, double sampleRate);
+
+    // getOrDesign() calls that found their sections, and those that had to design them
+    juce::uint64 getNumHits() const { return numHits.load(std::memory_order_relaxed); }
+    juce::uint64 getNumMisses() const { return numMisses.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::atomic<juce::uint32> sequence{ 0 };   // odd while being written
+        std::atomic<juce::uint64> key{ 0 };
+        std::atomic<int> numSections{ 0 };
+        std::array<std::atomic<float>, BiquadBank::maxSectionsPerBand * 5> coefficients{};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+
+    static int getFirstSlot(juce::uint64 key);
+
+    std::atomic<juce::uint64> numHits{ 0 }, numMisses{ 0 };
+
+    // neighbourhood designed around every centre, in steps either side
+    static constexpr int freqRadius = 32;
+    static constexpr int gainRadius = 12;
+    static constexpr int qualityRadius = 8;
+
+    juce::CriticalSection requestLock;
+    std::vector<BandSpec> requestedCentres;
+    double requestedSampleRate = 0.0;
+    bool requestPending = false;
+
+    void run() override;
+    void prewarmAround(const BandSpec& centre, double sampleRate);
+    void prewarmSpec(const BandSpec& spec, double sampleRate);
+};
@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+
+    DynamicEQ.cpp
+
+  ==============================================================================
+*/
+
+#include "DynamicEQ.h"
+
+bool PeakDynamics::operator==(const PeakDynamics& other) const
+{
+    return thresholdInDecibels == other.thresholdInDecibels
+        && ratio == other.ratio
+        && attackInMilliseconds == other.attackInMilliseconds
+        && releaseInMilliseconds == other.releaseInMilliseconds;
+}
+
+void PeakSectionDesigner::setFrequency(double sampleRate, float freq, float quality)
+{
+    auto omega = juce::MathConstants<double>::twoPi * juce::jmax((double)freq, 2.0) / sampleRate;
+
+    alpha = std::sin(omega) / ((double)quality * 2.0);
+    cosTerm = -2.0 * std::cos(omega);
+}
+
+PeakSectionDesigner::Section PeakSectionDesigner::makeSection(float gainInDecibels) const
+{
+    auto A = std::pow(10.0, (double)gainInDecibels / 40.0);   // sqrt of the linear gain
+    auto alphaTimesA = alpha * A;
+    auto alphaOverA = alpha / A;
+    auto a0Inverse = 1.0 / (1.0 + alphaOverA);
+
+    return { (float)((1.0 + alphaTimesA) * a0Inverse),
+             (float)(cosTerm * a0Inverse),
+             (float)((1.0 - alphaTimesA) * a0Inverse),
+             (float)(cosTerm * a0Inverse),
+             (float)((1.0 - alphaOverA) * a0Inverse) };
+}
+
+//==============================================================================
+void DynamicPeakBands::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    designed.fill(false);
+    dynamic.fill(false);
+    sections.fill({ 1.f, 0.f, 0.f, 0.f, 0.f });
+
+    reset();
+}
+
+void DynamicPeakBands::reset()
+{
+    s1.fill(0.f);
+    s2.fill(0.f);
+    envelope.fill(0.f);
+
+    for (auto& reduction : gainReduction)
+        reduction.store(0.f);
+}
+
+void DynamicPeakBands::setBand(int band, const PeakBandSettings& newSettings)
+{
+    jassert(juce::isPositiveAndBelow(band, numBands));
+
+    auto& current = settings[band];
+    const auto firstTime = !designed[band];
+
+    const auto filterChanged = firstTime || newSettings.freq != current.freq || newSettings.quality != current.quality;
+    const auto gainChanged = newSettings.gainInDecibels != current.gainInDecibels;
+
+    if (firstTime || newSettings.dynamics.attackInMilliseconds != current.dynamics.attackInMilliseconds)
+        attackCoefficient[band] = makeEnvelopeCoefficient(newSettings.dynamics.attackInMilliseconds);
+
+    if (firstTime || newSettings.dynamics.releaseInMilliseconds != current.dynamics.releaseInMilliseconds)
+        releaseCoefficient[band] = makeEnvelopeCoefficient(newSettings.dynamics.releaseInMilliseconds);
+
+    current = newSettings;
+    designed[band] = true;
+
+    keyLeft[band] = current.keyLeft;
+    keyRight[band] = current.keyRight;
+
+    if (filterChanged)
+    {
+        designers[band].setFrequency(sampleRate, current.freq, current.quality);
+        designDetector(band);
+    }
+
+    const auto wasDynamic = dynamic[band];
+    dynamic[band] = !current.bypassed && current.dynamics.ratio > 1.f;
+
+    if (!dynamic[band] && wasDynamic)
+        gainReduction[band].store(0.f);
+
+    if (filterChanged || gainChanged || wasDynamic != dynamic[band])
+        sections[band] = designers[band].makeSection(current.gainInDecibels - gainReduction[band].load());
+}
+
+bool DynamicPeakBands::isAnyBandDynamic() const
+{
+    return std::any_of(dynamic.begin(), dynamic.end(), [](bool d) { return d; });
+}
+
+void DynamicPeakBands::process(const float* left, const float* right, int numSamples)
+{
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const auto l = left[n];
+        const auto r = right[n];
+
+        for (int i = 0; i < numBands; ++i)
+        {
+            const auto x = keyLeft[i] * l + keyRight[i] * r;
+
+            const auto y = b0[i] * x + s1[i];
+            s1[i] = s2[i] - a1[i] * y;
+            s2[i] = b2[i] * x - a2[i] * y;
+
+            const auto level = std::abs(y);
+            const auto coefficient = level > envelope[i] ? attackCoefficient[i] : releaseCoefficient[i];
+            envelope[i] = level + coefficient * (envelope[i] - level);
+        }
+    }
+
+    // once per control period: the gain computer and the new sections
+    for (int i = 0; i < numBands; ++i)
+    {
+        if (!dynamic[i])
+            continue;
+
+        const auto& dynamics = settings[i].dynamics;
+
+        auto over = juce::Decibels::gainToDecibels(envelope[i], -100.f) - dynamics.thresholdInDecibels;
+        auto reduction = over > 0.f ? over * (1.f - 1.f / dynamics.ratio) : 0.f;
+        reduction = juce::jmin(reduction, maxGainReductionInDecibels);
+
+        gainReduction[i].store(reduction);
+        sections[i] = designers[i].makeSection(settings[i].gainInDecibels - reduction);
+    }
+}
+
+void DynamicPeakBands::designDetector(int band)
+{
+    const auto& current = settings[band];
+
+    auto omega = juce::MathConstants<double>::twoPi * juce::jmax((double)current.freq, 2.0) / sampleRate;
+    auto alpha = std::sin(omega) / ((double)current.quality * 2.0);
+    auto a0Inverse = 1.0 / (1.0 + alpha);
+
+    b0[band] = (float)(alpha * a0Inverse);
+    b2[band] = (float)(-alpha * a0Inverse);
+    a1[band] = (float)(-2.0 * std::cos(omega) * a0Inverse);
+    a2[band] = (float)((1.0 - alpha) * a0Inverse);
+}
+
+float DynamicPeakBands::makeEnvelopeCoefficient(float timeInMilliseconds) const
+{
+    auto timeInSamples = juce::jmax(1.0, (double)timeInMilliseconds * 0.001 * sampleRate);
+    return (float)std::exp(-1.0 / timeInSamples);
+}
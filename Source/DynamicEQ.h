@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    DynamicEQ.h
+
+    Dynamic gain for the four peak bands: a band-passed detector and an
+    envelope follower per band, with the band's peak gain pulled down by the
+    amount the envelope sits above its threshold.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+
+struct PeakDynamics
+{
+    float thresholdInDecibels{ 0 }, ratio{ 1.f };
+    float attackInMilliseconds{ 5.f }, releaseInMilliseconds{ 100.f };
+
+    bool operator==(const PeakDynamics& other) const;
+};
+
+struct PeakBandSettings
+{
+    float freq{ 1000.f }, quality{ 1.f }, gainInDecibels{ 0 };
+    PeakDynamics dynamics;
+    bool bypassed{ false };
+
+    // the detector hears keyLeft * left + keyRight * right, the signal of the domain the band filters
+    float keyLeft{ 0.5f }, keyRight{ 0.5f };
+};
+
+/*
+ the peak filter maths of IIR::Coefficients::makePeakFilter, split so that only the
+ gain term is evaluated per update: no allocation, one pow and one divide.
+ sections are { b0, b1, b2, a1, a2 }, normalised by a0.
+ */
+struct PeakSectionDesigner
+{
+    using Section = std::array<float, 5>;
+
+    void setFrequency(double sampleRate, float freq, float quality);
+    Section makeSection(float gainInDecibels) const;
+
+private:
+    double alpha = 0.0, cosTerm = 0.0;
+};
+
+/*
+ the four peak bands' detectors run side by side in structure-of-arrays form: every
+ per-sample step is a loop over the bands, which the compiler turns into one vector op.
+ a band is dynamic while it is not bypassed and its ratio is above 1:1.
+ */
+struct DynamicPeakBands
+{
+    static constexpr int numBands = 4;
+
+    // samples between gain updates
+    static constexpr int controlInterval = 32;
+
+    using Section = PeakSectionDesigner::Section;
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // audio thread. only redesigns what changed since the last call
+    void setBand(int band, const PeakBandSettings& settings);
+
+    bool isDynamic(int band) const { return dynamic[band]; }
+    bool isAnyBandDynamic() const;
+
+    // runs the detectors over one control period of stereo input, each on its band's key, and updates the dynamic bands' sections
+    void process(const float* left, const float* right, int numSamples);
+
+    const Section& getSection(int band) const { return sections[band]; }
+
+    // safe to read from any thread
+    float getGainReductionInDecibels(int band) const { return gainReduction[band].load(); }
+
+private:
+    using Lanes = std::array<float, numBands>;
+
+    static constexpr float maxGainReductionInDecibels = 24.f;
+
+    double sampleRate = 44100.0;
+
+    std::array<PeakBandSettings, numBands> settings;
+    std::array<bool, numBands> designed{};
+    std::array<bool, numBands> dynamic{};
+    std::array<PeakSectionDesigner, numBands> designers;
+    std::array<Section, numBands> sections;
+
+    // band-pass detectors (constant 0 dB peak gain, so b1 is always 0), transposed direct form II
+    alignas(16) Lanes keyLeft{}, keyRight{};
+    alignas(16) Lanes b0{}, b2{}, a1{}, a2{};
+    alignas(16) Lanes s1{}, s2{};
+
+    // peak envelope followers
+    alignas(16) Lanes envelope{}, attackCoefficient{}, releaseCoefficient{};
+
+    std::array<std::atomic<float>, numBands> gainReduction{};
+
+    void designDetector(int band);
+    float makeEnvelopeCoefficient(float timeInMilliseconds) const;
+};
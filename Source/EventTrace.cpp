@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    EventTrace.cpp
+
+  ==============================================================================
+*/
+
+#include "EventTrace.h"
+
+#if SPECTRUMEQ_TRACE
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        juce::uint64 start, end;
+    };
+
+    struct ThreadRing
+    {
+        std::array<Event, EventTrace::eventsPerThread> events;
+        std::atomic<juce::uint64> numWritten{ 0 };
+        std::atomic<bool> isMessageThread{ false };
+    };
+
+    struct Clock
+    {
+        juce::uint64 timestamp = 0;
+        juce::int64 ticks = 0;
+
+        static Clock sample() noexcept { return { EventTrace::now(), juce::Time::getHighResolutionTicks() }; }
+    };
+
+    std::array<ThreadRing, EventTrace::maxThreads> rings;
+    std::atomic<int> numRings{ 0 };
+
+    // sampled when the plugin is loaded, before any scope can run
+    const Clock firstClock = Clock::sample();
+
+    thread_local ThreadRing* threadRing = nullptr;
+    thread_local bool outOfRings = false;
+
+    ThreadRing* claimRing() noexcept
+    {
+        const auto index = numRings.fetch_add(1);
+
+        if (index >= EventTrace::maxThreads)
+            return nullptr;
+
+        auto& ring = rings[(size_t)index];
+        ring.isMessageThread.store(juce::MessageManager::existsAndIsCurrentThread());
+        return &ring;
+    }
+}
+
+juce::uint64 EventTrace::now() noexcept
+{
+   #if JUCE_INTEL
+    return (juce::uint64)__rdtsc();
+   #else
+    return (juce::uint64)juce::Time::getHighResolutionTicks();
+   #endif
+}
+
+void EventTrace::record(const char* name, juce::uint64 start, juce::uint64 end) noexcept
+{
+    if (threadRing == nullptr)
+    {
+        if (outOfRings)
+            return;
+
+        threadRing = claimRing();
+        outOfRings = threadRing == nullptr;
+
+        if (outOfRings)
+            return;
+    }
+
+    auto& ring = *threadRing;
+    const auto n = ring.numWritten.load(std::memory_order_relaxed);
+
+    ring.events[(size_t)(n % eventsPerThread)] = { name, start, end };
+    ring.numWritten.store(n + 1, std::memory_order_release);
+}
+
+juce::String EventTrace::toChromeJson()
+{
+    const auto lastClock = Clock::sample();
+    const auto loadClock = firstClock;
+
+    // timestamp units per microsecond, from the two clock samples
+    const auto elapsedSeconds = juce::Time::highResolutionTicksToSeconds(lastClock.ticks - loadClock.ticks);
+    const auto unitsPerMicrosecond = elapsedSeconds > 0.0
+                                   ? (double)(lastClock.timestamp - loadClock.timestamp) / (elapsedSeconds * 1.0e6)
+                                   : 1.0;
+
+    auto toMicroseconds = [&](juce::uint64 timestamp)
+    {
+        return (double)(juce::int64)(timestamp - loadClock.timestamp) / unitsPerMicrosecond;
+    };
+
+    juce::MemoryOutputStream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    auto first = true;
+    auto separator = [&]() -> const char* { return std::exchange(first, false) ? "\n" : ",\n"; };
+
+    const auto numThreads = juce::jmin(numRings.load(), maxThreads);
+    std::vector<Event> events;
+
+    for (int t = 0; t < numThreads; ++t)
+    {
+        const auto& ring = rings[(size_t)t];
+        const auto tid = t + 1;
+
+        json << separator() << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << tid
+             << ",\"args\":{\"name\":\"" << (ring.isMessageThread.load() ? "message thread" : "thread " + juce::String(tid)) << "\"}}";
+
+        // copy, then drop whatever the writer may have overwritten while we copied. it may
+        // be writing event writtenAfter, over event writtenAfter - eventsPerThread
+        const auto writtenBefore = ring.numWritten.load(std::memory_order_acquire);
+        const auto oldest = writtenBefore > (juce::uint64)eventsPerThread ? writtenBefore - eventsPerThread : 0;
+
+        events.clear();
+        for (auto n = oldest; n < writtenBefore; ++n)
+            events.push_back(ring.events[(size_t)(n % eventsPerThread)]);
+
+        const auto writtenAfter = ring.numWritten.load(std::memory_order_acquire);
+        const auto firstIntact = writtenAfter >= (juce::uint64)eventsPerThread ? writtenAfter - eventsPerThread + 1 : 0;
+        const auto skip = (size_t)juce::jmin((juce::uint64)events.size(), firstIntact > oldest ? firstIntact - oldest : 0);
+
+        for (auto e = events.begin() + (std::ptrdiff_t)skip; e != events.end(); ++e)
+        {
+            json << separator() << "{\"ph\":\"X\",\"name\":\"" << e->name << "\",\"pid\":1,\"tid\":" << tid
+                 << ",\"ts\":" << juce::String(toMicroseconds(e->start), 3)
+                 << ",\"dur\":" << juce::String(toMicroseconds(e->end) - toMicroseconds(e->start), 3) << "}";
+        }
+    }
+
+    json << "\n]}\n";
+    return json.toString();
+}
+
+bool EventTrace::writeChromeJson(const juce::File& file)
+{
+    return file.replaceWithText(toChromeJson());
+}
+
+#endif
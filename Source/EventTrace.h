@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    EventTrace.h
+
+    Scoped timing of the audio and GUI hot paths, dumped as a Chrome trace
+    (chrome://tracing, ui.perfetto.dev) to see which one a stutter came from.
+
+    Off by default, and SPECTRUMEQ_TRACE_SCOPE() compiles to nothing then.
+    Build with SPECTRUMEQ_TRACE=1 to record; the editor then writes a trace
+    to the desktop on Ctrl+Shift+T (Cmd+Shift+T on macOS) and logs where
+    through juce::Logger.
+
+    SPECTRUMEQ_DEBUG_STATS=1 separately logs the paint timing and FFT cache
+    statistics through juce::Logger, in debug and release builds alike.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef SPECTRUMEQ_TRACE
+ #define SPECTRUMEQ_TRACE 0
+#endif
+
+#ifndef SPECTRUMEQ_DEBUG_STATS
+ #define SPECTRUMEQ_DEBUG_STATS 0
+#endif
+
+#if SPECTRUMEQ_TRACE
+
+/*
+ every thread that enters a scope claims one of maxThreads fixed rings the first time,
+ so recording never allocates or locks, not even on the audio thread. a ring has a
+ single writer and keeps its last eventsPerThread events.
+
+ timestamps are raw TSC reads where there is one (x86), high resolution ticks
+ otherwise. the dump converts them to microseconds against high resolution ticks
+ sampled when the plugin was loaded and again at the dump.
+ */
+struct EventTrace
+{
+    static constexpr int maxThreads = 16;
+    static constexpr int eventsPerThread = 8192;
+
+    // name must outlive the trace, i.e. be a string literal
+    struct Scope
+    {
+        explicit Scope(const char* scopeName) noexcept : name(scopeName), start(now()) {}
+        ~Scope() noexcept { record(name, start, now()); }
+
+        const char* name;
+        juce::uint64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    static juce::uint64 now() noexcept;
+    static void record(const char* name, juce::uint64 start, juce::uint64 end) noexcept;
+
+    // every event still in the rings, as Chrome trace event format JSON. any thread, while recording goes on
+    static juce::String toChromeJson();
+    static bool writeChromeJson(const juce::File& file);
+};
+
+ #define SPECTRUMEQ_TRACE_CONCAT_(a, b) a##b
+ #define SPECTRUMEQ_TRACE_CONCAT(a, b) SPECTRUMEQ_TRACE_CONCAT_(a, b)
+ #define SPECTRUMEQ_TRACE_SCOPE(name) const EventTrace::Scope SPECTRUMEQ_TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#else
+
+ #define SPECTRUMEQ_TRACE_SCOPE(name)
+
+#endif
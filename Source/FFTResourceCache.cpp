@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    FFTResourceCache.cpp
+
+  ==============================================================================
+*/
+
+#include "FFTResourceCache.h"
+#include "EventTrace.h"
+
+static std::vector<float> makeWindowTable(int size, juce::dsp::WindowingFunction<float>::WindowingMethod method)
+{
+    std::vector<float> table((size_t)size);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(table.data(), (size_t)size, method, true);
+    return table;
+}
+
+FFTResources::FFTResources(int order, juce::dsp::WindowingFunction<float>::WindowingMethod method) :
+    fft(order),
+    window(makeWindowTable(1 << order, method))
+{
+}
+
+size_t FFTResources::getApproximateSizeInBytes() const
+{
+    const auto size = (size_t)fft.getSize();
+    return size * sizeof(float) + size * sizeof(std::complex<float>);
+}
+
+//==============================================================================
+std::mutex& FFTResourceCache::getMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::map<FFTResourceCache::Key, std::weak_ptr<const FFTResources>>& FFTResourceCache::getEntries()
+{
+    static std::map<Key, std::weak_ptr<const FFTResources>> entries;
+    return entries;
+}
+
+FFTResourceCache::Handle FFTResourceCache::acquire(int order, juce::dsp::WindowingFunction<float>::WindowingMethod method)
+{
+    const std::lock_guard<std::mutex> lock(getMutex());
+    auto& entries = getEntries();
+    auto& entry = entries[{ order, (int)method }];
+
+    auto handle = entry.lock();
+    const auto reused = handle != nullptr;
+
+    if (!reused)
+    {
+        handle = std::make_shared<const FFTResources>(order, method);
+        entry = handle;
+
+        // entries whose last handle has gone
+        for (auto it = entries.begin(); it != entries.end();)
+            it = it->second.expired() ? entries.erase(it) : std::next(it);
+    }
+
+   #if SPECTRUMEQ_DEBUG_STATS
+    juce::Logger::writeToLog("FFT cache: order " + juce::String(order) + (reused ? " shared, " : " created, ") + getStatsLocked().toString());
+   #else
+    juce::ignoreUnused(reused);
+   #endif
+
+    return handle;
+}
+
+juce::String FFTResourceCache::Stats::toString() const
+{
+    return juce::String(numHandles) + " handles over " + juce::String(numEntries) + " tables, ~"
+         + juce::String((int)(bytesInUse / 1024)) + " KB in use, ~" + juce::String((int)(bytesSaved / 1024)) + " KB saved";
+}
+
+FFTResourceCache::Stats FFTResourceCache::getStats()
+{
+    const std::lock_guard<std::mutex> lock(getMutex());
+    return getStatsLocked();
+}
+
+FFTResourceCache::Stats FFTResourceCache::getStatsLocked()
+{
+    Stats stats;
+
+    for (const auto& [key, weak] : getEntries())
+    {
+        juce::ignoreUnused(key);
+
+        if (auto entry = weak.lock())
+        {
+            // minus the one we just took to look at it
+            const auto handles = (int)entry.use_count() - 1;
+            const auto bytes = entry->getApproximateSizeInBytes();
+
+            stats.numEntries += 1;
+            stats.numHandles += handles;
+            stats.bytesInUse += bytes;
+            stats.bytesSaved += (size_t)juce::jmax(0, handles - 1) * bytes;
+        }
+    }
+
+    return stats;
+}
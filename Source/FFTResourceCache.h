@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    FFTResourceCache.h
+
+    FFT engines and window tables shared by every analyzer in the process.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <map>
+
+/*
+ one FFT engine and one window table for an (order, window type) pair. both are
+ read-only after construction (performFrequencyOnlyForwardTransform() is const),
+ so any number of analyzers on any threads can use the same instance.
+ */
+struct FFTResources
+{
+    FFTResources(int order, juce::dsp::WindowingFunction<float>::WindowingMethod method);
+
+    const juce::dsp::FFT fft;
+    const std::vector<float> window;
+
+    // the window plus a lower bound for the engine's twiddle tables
+    size_t getApproximateSizeInBytes() const;
+};
+
+/*
+ reference-counted, thread-safe cache of FFTResources keyed by order and window type.
+ an entry lives while any handle to it does; the cache itself only holds weak references.
+ */
+struct FFTResourceCache
+{
+    using Handle = std::shared_ptr<const FFTResources>;
+
+    static Handle acquire(int order, juce::dsp::WindowingFunction<float>::WindowingMethod method);
+
+    struct Stats
+    {
+        int numEntries = 0;
+        int numHandles = 0;
+        size_t bytesInUse = 0;
+        size_t bytesSaved = 0;     // what the handles beyond the first would have cost with private copies
+
+        // one line for the log
+        juce::String toString() const;
+    };
+
+    static Stats getStats();
+
+private:
+    using Key = std::pair<int, int>;
+
+    static std::mutex& getMutex();
+    static std::map<Key, std::weak_ptr<const FFTResources>>& getEntries();
+
+    static Stats getStatsLocked();
+};
@@ -0,0 +1,361 @@
+/*
+  ==============================================================================
+
+    FilterEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "FilterEngine.h"
+#include "EventTrace.h"
+
+#include <tuple>
+
+bool ChainSettings::operator==(const ChainSettings& other) const
+{
+    auto tie = [](const ChainSettings& s)
+    {
+        return std::tie(s.lowPeakFreq, s.lowPeakGainInDecibels, s.lowPeakQuality,
+                        s.lowMidPeakFreq, s.lowMidPeakGainInDecibels, s.lowMidPeakQuality,
+                        s.highMidPeakFreq, s.highMidPeakGainInDecibels, s.highMidPeakQuality,
+                        s.highPeakFreq, s.highPeakGainInDecibels, s.highPeakQuality,
+                        s.lowCutFreq, s.highCutFreq, s.lowCutSlope, s.highCutSlope,
+                        s.lowCutBypassed, s.lowPeakBypassed, s.lowMidPeakBypassed,
+                        s.highMidPeakBypassed, s.highPeakBypassed, s.highCutBypassed,
+                        s.lowPeakDynamics, s.lowMidPeakDynamics, s.highMidPeakDynamics, s.highPeakDynamics,
+                        s.lowCutRouting, s.lowPeakRouting, s.lowMidPeakRouting,
+                        s.highMidPeakRouting, s.highPeakRouting, s.highCutRouting);
+    };
+
+    return tie(*this) == tie(other);
+}
+
+//==============================================================================
+std::array<BandSpec, numPanelBands> makePanelBands(const ChainSettings& chainSettings)
+{
+    auto cut = [](PanelBand position, float freq, Slope slope)
+    {
+        BandSpec spec;
+        spec.type = panelBandTypes[position];
+        spec.freq = freq;
+        spec.order = 2 * (slope + 1);
+        return spec;
+    };
+
+    auto peak = [](PanelBand position, float freq, float quality, float gainInDecibels)
+    {
+        BandSpec spec;
+        spec.type = panelBandTypes[position];
+        spec.freq = freq;
+        spec.quality = quality;
+        spec.gainInDecibels = gainInDecibels;
+        return spec;
+    };
+
+    return
+    {
+        cut(LowCut, chainSettings.lowCutFreq, chainSettings.lowCutSlope),
+        peak(LowPeak, chainSettings.lowPeakFreq, chainSettings.lowPeakQuality, chainSettings.lowPeakGainInDecibels),
+        peak(LowMidPeak, chainSettings.lowMidPeakFreq, chainSettings.lowMidPeakQuality, chainSettings.lowMidPeakGainInDecibels),
+        peak(HighMidPeak, chainSettings.highMidPeakFreq, chainSettings.highMidPeakQuality, chainSettings.highMidPeakGainInDecibels),
+        peak(HighPeak, chainSettings.highPeakFreq, chainSettings.highPeakQuality, chainSettings.highPeakGainInDecibels),
+        cut(HighCut, chainSettings.highCutFreq, chainSettings.highCutSlope)
+    };
+}
+
+std::array<bool, numPanelBands> makePanelBypassed(const ChainSettings& chainSettings)
+{
+    return
+    {
+        chainSettings.lowCutBypassed, chainSettings.lowPeakBypassed, chainSettings.lowMidPeakBypassed,
+        chainSettings.highMidPeakBypassed, chainSettings.highPeakBypassed, chainSettings.highCutBypassed
+    };
+}
+
+std::array<PeakBandSettings, DynamicPeakBands::numBands> makePeakBandSettings(const ChainSettings& chainSettings)
+{
+    // keyed from the domain the band filters, with the same scaling as encodeMidSide(). a stereo band is linked, on the mid
+    auto peak = [](float freq, float quality, float gainInDecibels, const PeakDynamics& dynamics, bool bypassed, BandRouting routing)
+    {
+        PeakBandSettings settings{ freq, quality, gainInDecibels, dynamics, bypassed };
+
+        switch (routing)
+        {
+            case Routing_Stereo:
+            case Routing_Mid:   settings.keyLeft = 0.5f; settings.keyRight = 0.5f;  break;
+            case Routing_Side:  settings.keyLeft = 0.5f; settings.keyRight = -0.5f; break;
+            case Routing_Left:  settings.keyLeft = 1.f;  settings.keyRight = 0.f;   break;
+            case Routing_Right: settings.keyLeft = 0.f;  settings.keyRight = 1.f;   break;
+        }
+
+        return settings;
+    };
+
+    return
+    {
+        peak(chainSettings.lowPeakFreq, chainSettings.lowPeakQuality, chainSettings.lowPeakGainInDecibels,
+             chainSettings.lowPeakDynamics, chainSettings.lowPeakBypassed, chainSettings.lowPeakRouting),
+        peak(chainSettings.lowMidPeakFreq, chainSettings.lowMidPeakQuality, chainSettings.lowMidPeakGainInDecibels,
+             chainSettings.lowMidPeakDynamics, chainSettings.lowMidPeakBypassed, chainSettings.lowMidPeakRouting),
+        peak(chainSettings.highMidPeakFreq, chainSettings.highMidPeakQuality, chainSettings.highMidPeakGainInDecibels,
+             chainSettings.highMidPeakDynamics, chainSettings.highMidPeakBypassed, chainSettings.highMidPeakRouting),
+        peak(chainSettings.highPeakFreq, chainSettings.highPeakQuality, chainSettings.highPeakGainInDecibels,
+             chainSettings.highPeakDynamics, chainSettings.highPeakBypassed, chainSettings.highPeakRouting)
+    };
+}
+
+//==============================================================================
+RoutingPlan RoutingPlan::make(const ChainSettings& chainSettings)
+{
+    const auto bypassed = makePanelBypassed(chainSettings);
+
+    const std::array<BandRouting, numBands> routing
+    {
+        chainSettings.lowCutRouting, chainSettings.lowPeakRouting, chainSettings.lowMidPeakRouting,
+        chainSettings.highMidPeakRouting, chainSettings.highPeakRouting, chainSettings.highCutRouting
+    };
+
+    RoutingPlan plan;
+    bool domainChosen = false;
+
+    for (int band = 0; band < numBands; ++band)
+    {
+        if (bypassed[band])
+            continue;
+
+        const auto r = routing[band];
+        const auto needsMidSide = r == Routing_Mid || r == Routing_Side;
+        const auto needsLeftRight = r == Routing_Left || r == Routing_Right;
+
+        if (plan.numSegments == 0)
+            plan.numSegments = 1;
+
+        if (needsMidSide || needsLeftRight)
+        {
+            if (domainChosen && plan.segments[plan.numSegments - 1].midSide != needsMidSide)
+                ++plan.numSegments;
+
+            plan.segments[plan.numSegments - 1].midSide = needsMidSide;
+            domainChosen = true;
+        }
+
+        auto& segment = plan.segments[plan.numSegments - 1];
+        const auto bit = 1u << band;
+
+        if (r != Routing_Side && r != Routing_Right)
+            segment.activeBands[0] |= bit;
+
+        if (r != Routing_Mid && r != Routing_Left)
+            segment.activeBands[1] |= bit;
+    }
+
+    return plan;
+}
+
+static void encodeMidSide(juce::dsp::AudioBlock<float>& block)
+{
+    auto* left = block.getChannelPointer(0);
+    auto* right = block.getChannelPointer(1);
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i)
+    {
+        const auto mid = 0.5f * (left[i] + right[i]);
+        const auto side = 0.5f * (left[i] - right[i]);
+
+        left[i] = mid;
+        right[i] = side;
+    }
+}
+
+static void decodeMidSide(juce::dsp::AudioBlock<float>& block)
+{
+    auto* mid = block.getChannelPointer(0);
+    auto* side = block.getChannelPointer(1);
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i)
+    {
+        const auto left = mid[i] + side[i];
+        const auto right = mid[i] - side[i];
+
+        mid[i] = left;
+        side[i] = right;
+    }
+}
+
+void RoutingPlan::process(BiquadBank& bank, juce::dsp::AudioBlock<float> block) const
+{
+    const auto numSamples = (int)block.getNumSamples();
+    bool inMidSide = false;
+
+    for (int i = 0; i < numSegments; ++i)
+    {
+        const auto& segment = segments[i];
+
+        if (segment.midSide != inMidSide)
+        {
+            if (segment.midSide)
+                encodeMidSide(block);
+            else
+                decodeMidSide(block);
+
+            inMidSide = segment.midSide;
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            if (segment.activeBands[channel] != 0)
+                bank.process(block.getChannelPointer((size_t)channel), channel, numSamples, segment.activeBands[channel]);
+        }
+    }
+
+    if (inMidSide)
+        decodeMidSide(block);
+}
+
+//==============================================================================
+ChainCoefficients ChainCoefficients::design(const ChainSettings& chainSettings, double sampleRate)
+{
+    ChainCoefficients chainCoefficients;
+    chainCoefficients.sampleRate = sampleRate;
+    chainCoefficients.settings = chainSettings;
+    chainCoefficients.bands = makePanelBands(chainSettings);
+
+    for (size_t band = 0; band < chainCoefficients.bands.size(); ++band)
+    {
+        chainCoefficients.numSections[band] = BiquadBank::design(chainCoefficients.bands[band],
+                                                                 sampleRate,
+                                                                 chainCoefficients.sections[band].data());
+    }
+
+    return chainCoefficients;
+}
+
+void applyChainCoefficients(BiquadBank& bank, const ChainCoefficients& chainCoefficients)
+{
+    for (int band = 0; band < numPanelBands; ++band)
+    {
+        bank.setBand(band,
+                     chainCoefficients.bands[(size_t)band],
+                     chainCoefficients.sections[(size_t)band].data(),
+                     chainCoefficients.numSections[(size_t)band]);
+    }
+}
+
+//==============================================================================
+void FilterEngine::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    biquadBank.setCoefficientCache(&coefficientCache);
+    biquadBank.prepare(sampleRate);
+    biquadBank.setNumBands(numPanelBands);
+    numExtraBands = 0;
+
+    dynamicPeaks.prepare(sampleRate);
+
+    // the bank was just reset, so nothing in it is left from a recall
+    holdsRecalledSettings = false;
+}
+
+void FilterEngine::prewarm(const std::vector<BandSpec>& centres)
+{
+    coefficientCache.prewarm(centres, sampleRate);
+}
+
+void FilterEngine::update(const ChainSettings& chainSettings)
+{
+    SPECTRUMEQ_TRACE_SCOPE("updateFilters");
+
+    // a recalled preset already loaded the static bands and the routing; nothing to redo until a parameter moves
+    const auto recalled = holdsRecalledSettings && chainSettings == recalledSettings;
+    holdsRecalledSettings = recalled;
+
+    const auto peaks = makePeakBandSettings(chainSettings);
+
+    for (int i = 0; i < DynamicPeakBands::numBands; ++i)
+        dynamicPeaks.setBand(i, peaks[(size_t)i]);
+
+    if (!recalled)
+    {
+        const auto bands = makePanelBands(chainSettings);
+
+        for (int band = 0; band < numPanelBands; ++band)
+        {
+            const auto peak = band - PanelBand::LowPeak;
+
+            // a dynamic band gets its sections from applyDynamicPeakSections() instead
+            if (!(juce::isPositiveAndBelow(peak, DynamicPeakBands::numBands) && dynamicPeaks.isDynamic(peak)))
+                biquadBank.setBand(band, bands[(size_t)band]);
+        }
+
+        routingPlan = RoutingPlan::make(chainSettings);
+    }
+
+    applyDynamicPeakSections();
+}
+
+void FilterEngine::recall(const ChainCoefficients& chainCoefficients)
+{
+    applyChainCoefficients(biquadBank, chainCoefficients);
+    routingPlan = RoutingPlan::make(chainCoefficients.settings);
+
+    recalledSettings = chainCoefficients.settings;
+    holdsRecalledSettings = true;
+}
+
+void FilterEngine::setExtraBands(const BandSpec* bands, int numBands)
+{
+    jassert(juce::isPositiveAndNotGreaterThan(numBands, maxExtraBands));
+
+    numExtraBands = juce::jlimit(0, maxExtraBands, numBands);
+    biquadBank.setNumBands(numPanelBands + numExtraBands);
+
+    for (int i = 0; i < numExtraBands; ++i)
+        biquadBank.setBand(numPanelBands + i, bands[i]);
+}
+
+void FilterEngine::process(juce::dsp::AudioBlock<float> block)
+{
+    jassert(block.getNumChannels() == (size_t)RoutingPlan::numChannels);
+
+    if (!dynamicPeaks.isAnyBandDynamic())
+    {
+        processBands(block);
+        return;
+    }
+
+    // each control period: detect on the input, each band in its own domain, move the dynamic bands' gain, then filter that stretch
+    const auto numSamples = (int)block.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += DynamicPeakBands::controlInterval)
+    {
+        const auto length = juce::jmin(DynamicPeakBands::controlInterval, numSamples - start);
+
+        dynamicPeaks.process(block.getChannelPointer(0) + start, block.getChannelPointer(1) + start, length);
+        applyDynamicPeakSections();
+
+        processBands(block.getSubBlock((size_t)start, (size_t)length));
+    }
+}
+
+void FilterEngine::processBands(juce::dsp::AudioBlock<float> block)
+{
+    routingPlan.process(biquadBank, block);
+
+    if (numExtraBands == 0)
+        return;
+
+    const auto extraBands = ((1u << numExtraBands) - 1u) << numPanelBands;
+
+    for (int channel = 0; channel < RoutingPlan::numChannels; ++channel)
+        biquadBank.process(block.getChannelPointer((size_t)channel), channel, (int)block.getNumSamples(), extraBands);
+}
+
+void FilterEngine::applyDynamicPeakSections()
+{
+    for (int i = 0; i < DynamicPeakBands::numBands; ++i)
+    {
+        if (dynamicPeaks.isDynamic(i))
+            biquadBank.overrideSections(PanelBand::LowPeak + i, &dynamicPeaks.getSection(i), 1);
+    }
+}
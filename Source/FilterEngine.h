@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    FilterEngine.h
+
+    The panel's bands as the audio thread runs them: static bands in a
+    BiquadBank, the dynamic peaks on top, and the per-band routing. Needs
+    no AudioProcessor, so the golden render and the console tool run the
+    same code the plugin does.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "BiquadBank.h"
+#include "CoefficientCache.h"
+#include "DynamicEQ.h"
+
+#include <array>
+#include <vector>
+
+enum Slope
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+enum BandRouting
+{
+    Routing_Stereo,
+    Routing_Mid,
+    Routing_Side,
+    Routing_Left,
+    Routing_Right
+};
+
+struct ChainSettings
+{
+    float lowPeakFreq{ 0 }, lowPeakGainInDecibels{ 0 }, lowPeakQuality{ 1.f };
+    float lowMidPeakFreq{ 0 }, lowMidPeakGainInDecibels{ 0 }, lowMidPeakQuality{ 1.f };
+    float highMidPeakFreq{ 0 }, highMidPeakGainInDecibels{ 0 }, highMidPeakQuality{ 1.f };
+    float highPeakFreq{ 0 }, highPeakGainInDecibels{ 0 }, highPeakQuality{ 1.f };
+    float lowCutFreq{ 0 }, highCutFreq{ 0 };
+
+    Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+
+    bool lowCutBypassed{ false }, lowPeakBypassed{ false }, lowMidPeakBypassed{ false },
+        highMidPeakBypassed{ false }, highPeakBypassed{ false }, highCutBypassed{ false };
+
+    PeakDynamics lowPeakDynamics, lowMidPeakDynamics, highMidPeakDynamics, highPeakDynamics;
+
+    BandRouting lowCutRouting{ Routing_Stereo }, lowPeakRouting{ Routing_Stereo }, lowMidPeakRouting{ Routing_Stereo },
+        highMidPeakRouting{ Routing_Stereo }, highPeakRouting{ Routing_Stereo }, highCutRouting{ Routing_Stereo };
+
+    bool operator==(const ChainSettings& other) const;
+    bool operator!=(const ChainSettings& other) const { return !(*this == other); }
+};
+
+enum PanelBand
+{
+    LowCut,
+    LowPeak,
+    LowMidPeak,
+    HighMidPeak,
+    HighPeak,
+    HighCut
+};
+
+// the panel's bands are the first entries of the bank's runtime band list, in this order
+constexpr int numPanelBands = HighCut + 1;
+static_assert(numPanelBands <= BiquadBank::maxBands, "the bank holds every panel band");
+
+inline constexpr std::array<BandType, numPanelBands> panelBandTypes
+{
+    BandType::LowCut, BandType::Peak, BandType::Peak, BandType::Peak, BandType::Peak, BandType::HighCut
+};
+
+std::array<BandSpec, numPanelBands> makePanelBands(const ChainSettings& chainSettings);
+std::array<bool, numPanelBands> makePanelBypassed(const ChainSettings& chainSettings);
+std::array<PeakBandSettings, DynamicPeakBands::numBands> makePeakBandSettings(const ChainSettings& chainSettings);
+
+/*
+ ready-to-use coefficients for one ChainSettings at one sample rate, stored by value
+ so the audio thread can apply them without allocating or designing anything.
+ */
+struct ChainCoefficients
+{
+    using Section = BiquadBank::Section;
+
+    double sampleRate = 0.0;
+    ChainSettings settings;
+
+    std::array<BandSpec, numPanelBands> bands;
+    std::array<std::array<Section, BiquadBank::maxSectionsPerBand>, numPanelBands> sections;
+    std::array<int, numPanelBands> numSections{};
+
+    static ChainCoefficients design(const ChainSettings& chainSettings, double sampleRate);
+};
+
+void applyChainCoefficients(BiquadBank& bank, const ChainCoefficients& chainCoefficients);
+
+/*
+ which bands each chain runs, and in which domain. consecutive bands that can share
+ a domain share a segment; Stereo bands fit either, so the signal is only mid/side
+ encoded around the segments that need it, and a chain with no bands in a segment
+ is not processed at all.
+ */
+struct RoutingPlan
+{
+    static constexpr int numBands = numPanelBands;
+    static constexpr int numChannels = 2;
+
+    struct Segment
+    {
+        bool midSide = false;
+        std::array<juce::uint32, 2> activeBands{};   // bit per PanelBand, for chain 0 (left/mid) and 1 (right/side)
+    };
+
+    std::array<Segment, numBands> segments;
+    int numSegments = 0;
+
+    static RoutingPlan make(const ChainSettings& chainSettings);
+
+    // runs bank over a stereo block as planned
+    void process(BiquadBank& bank, juce::dsp::AudioBlock<float> block) const;
+};
+
+/*
+ update() redesigns only the bands whose spec moved (through the coefficient cache),
+ and leaves the static bands and the routing alone while the settings still match a
+ recalled preset. the dynamic bands get new sections every controlInterval samples
+ of process(), from detectors that run on its input.
+ */
+struct FilterEngine
+{
+    // clears every band's state; the next update() designs them all
+    void prepare(double sampleRate);
+
+    // designs the quantised neighbourhood of centres in the background, see CoefficientCache
+    void prewarm(const std::vector<BandSpec>& centres);
+
+    // audio thread
+    void update(const ChainSettings& chainSettings);
+
+    // audio thread. loads a recalled preset's precomputed coefficients at once
+    void recall(const ChainCoefficients& chainCoefficients);
+
+    /*
+     audio thread. bands after the panel's, up to the bank's capacity: any BandType, run on
+     both channels after the panel's bands. like the panel's, a band is only redesigned when
+     its spec changes. prepare() drops them
+     */
+    static constexpr int maxExtraBands = BiquadBank::maxBands - numPanelBands;
+    void setExtraBands(const BandSpec* bands, int numBands);
+    int getNumExtraBands() const { return numExtraBands; }
+
+    /*
+     audio thread. filters a stereo block in place, all on the calling thread: the processor
+     only accepts stereo, and with two channels (mid/side routing ties them together besides)
+     handing one to a worker costs more than it saves. OfflineRender splits long renders instead
+     */
+    void process(juce::dsp::AudioBlock<float> block);
+
+private:
+    double sampleRate = 44100.0;
+
+    // declared before the bank that points at it
+    CoefficientCache coefficientCache;
+    BiquadBank biquadBank;
+
+    DynamicPeakBands dynamicPeaks;
+    RoutingPlan routingPlan;
+
+    int numExtraBands = 0;
+
+    // what the bank was last loaded with from a recalled preset. while the
+    // settings still match it, only the dynamic bands need updating
+    ChainSettings recalledSettings;
+    bool holdsRecalledSettings = false;
+
+    void applyDynamicPeakSections();
+
+    // the panel's bands as routed, then the extra bands
+    void processBands(juce::dsp::AudioBlock<float> block);
+};
@@ -0,0 +1,792 @@
+/*
+  ==============================================================================
+
+    GoldenRender.cpp
+
+  ==============================================================================
+*/
+
+#include "GoldenRender.h"
+#include "FilterEngine.h"
+
+#include <map>
+
+namespace
+{
+    constexpr double primarySampleRate = 48000.0;
+
+    struct Configuration
+    {
+        juce::String name;
+        ChainSettings settings;
+        std::vector<double> sampleRates{ primarySampleRate };
+        std::vector<BandSpec> extraBands;   // after the panel's, see FilterEngine::setExtraBands()
+    };
+
+    struct Stimulus
+    {
+        juce::String name;
+        std::array<std::vector<float>, 2> channels;
+    };
+
+    ChainSettings makeBaseSettings()
+    {
+        ChainSettings settings;
+
+        settings.lowCutFreq = 40.f;
+        settings.highCutFreq = 12000.f;
+
+        settings.lowPeakFreq = 100.f;
+        settings.lowPeakGainInDecibels = 6.f;
+        settings.lowPeakQuality = 1.f;
+
+        settings.lowMidPeakFreq = 400.f;
+        settings.lowMidPeakGainInDecibels = -6.f;
+        settings.lowMidPeakQuality = 2.f;
+
+        settings.highMidPeakFreq = 1500.f;
+        settings.highMidPeakGainInDecibels = 9.f;
+        settings.highMidPeakQuality = 0.7f;
+
+        settings.highPeakFreq = 5000.f;
+        settings.highPeakGainInDecibels = -12.f;
+        settings.highPeakQuality = 4.f;
+
+        return settings;
+    }
+
+    BandSpec makeBand(BandType type, float freq, float quality, float gainInDecibels, int order = 2)
+    {
+        BandSpec spec;
+        spec.type = type;
+        spec.freq = freq;
+        spec.quality = quality;
+        spec.gainInDecibels = gainInDecibels;
+        spec.order = order;
+        return spec;
+    }
+
+    void setBypassed(ChainSettings& settings, int mask)
+    {
+        auto isBypassed = [mask](PanelBand position) { return (mask & (1 << position)) != 0; };
+
+        settings.lowCutBypassed = isBypassed(LowCut);
+        settings.lowPeakBypassed = isBypassed(LowPeak);
+        settings.lowMidPeakBypassed = isBypassed(LowMidPeak);
+        settings.highMidPeakBypassed = isBypassed(HighMidPeak);
+        settings.highPeakBypassed = isBypassed(HighPeak);
+        settings.highCutBypassed = isBypassed(HighCut);
+    }
+
+    // in PanelBand order
+    void setRouting(ChainSettings& settings, const std::array<BandRouting, numPanelBands>& routing)
+    {
+        settings.lowCutRouting = routing[LowCut];
+        settings.lowPeakRouting = routing[LowPeak];
+        settings.lowMidPeakRouting = routing[LowMidPeak];
+        settings.highMidPeakRouting = routing[HighMidPeak];
+        settings.highPeakRouting = routing[HighPeak];
+        settings.highCutRouting = routing[HighCut];
+    }
+
+    std::vector<Configuration> makeConfigurations()
+    {
+        std::vector<Configuration> configurations;
+        const auto base = makeBaseSettings();
+        const auto allBands = (1 << numPanelBands) - 1;
+
+        // at 24 dB/Oct every bypass combination; at the other slopes everything in, each band
+        // out on its own, and everything out
+        std::vector<int> allMasks, someMasks{ 0 };
+
+        for (int mask = 0; mask <= allBands; ++mask)
+            allMasks.push_back(mask);
+
+        for (int band = 0; band < numPanelBands; ++band)
+            someMasks.push_back(1 << band);
+
+        someMasks.push_back(allBands);
+
+        for (int slope = Slope_12; slope <= Slope_48; ++slope)
+        {
+            for (auto mask : slope == Slope_24 ? allMasks : someMasks)
+            {
+                auto settings = base;
+                settings.lowCutSlope = static_cast<Slope>(slope);
+                settings.highCutSlope = static_cast<Slope>(slope);
+                setBypassed(settings, mask);
+
+                Configuration configuration{ "slope" + juce::String(12 + slope * 12) + "-bypass" + juce::String::toHexString(mask).paddedLeft('0', 2),
+                                             settings };
+
+                // the cuts move furthest with the sample rate, so the gentlest and steepest run at all of them
+                if (mask == 0 && (slope == Slope_12 || slope == Slope_48))
+                    configuration.sampleRates = { 44100.0, primarySampleRate, 96000.0, 192000.0 };
+
+                configurations.push_back(configuration);
+            }
+        }
+
+        // routing: one domain for all the peaks, then segments that switch domain and skip chains
+        const std::array<std::pair<const char*, std::array<BandRouting, numPanelBands>>, 6> routings
+        {{
+            { "routing-mid",        { Routing_Stereo, Routing_Mid,   Routing_Mid,   Routing_Mid,    Routing_Mid,   Routing_Stereo } },
+            { "routing-side",       { Routing_Stereo, Routing_Side,  Routing_Side,  Routing_Side,   Routing_Side,  Routing_Stereo } },
+            { "routing-left",       { Routing_Left,   Routing_Left,  Routing_Left,  Routing_Left,   Routing_Left,  Routing_Left   } },
+            { "routing-right",      { Routing_Stereo, Routing_Right, Routing_Right, Routing_Stereo, Routing_Right, Routing_Right  } },
+            { "routing-mixed",      { Routing_Stereo, Routing_Mid,   Routing_Side,  Routing_Left,   Routing_Right, Routing_Mid    } },
+            { "routing-alternating",{ Routing_Mid,    Routing_Left,  Routing_Side,  Routing_Right,  Routing_Mid,   Routing_Left   } },
+        }};
+
+        for (const auto& [name, routing] : routings)
+        {
+            auto settings = base;
+            setRouting(settings, routing);
+            configurations.push_back({ name, settings });
+        }
+
+        // dynamic peaks: the stimuli sit well above these thresholds, so the gain moves
+        {
+            auto settings = base;
+            settings.lowPeakDynamics = { -30.f, 4.f, 1.f, 50.f };
+            configurations.push_back({ "dynamic-low", settings });
+        }
+
+        {
+            auto settings = base;
+            settings.lowPeakDynamics = { -30.f, 4.f, 1.f, 50.f };
+            settings.lowMidPeakDynamics = { -24.f, 2.f, 5.f, 100.f };
+            settings.highMidPeakDynamics = { -36.f, 8.f, 0.5f, 20.f };
+            settings.highPeakDynamics = { -20.f, 3.f, 10.f, 200.f };
+
+            configurations.push_back({ "dynamic-all", settings, { 44100.0, primarySampleRate, 96000.0, 192000.0 } });
+
+            setRouting(settings, { Routing_Stereo, Routing_Mid, Routing_Side, Routing_Left, Routing_Right, Routing_Stereo });
+            settings.lowMidPeakBypassed = true;
+            configurations.push_back({ "dynamic-routed", settings });
+        }
+
+        // the band types the panel doesn't use, each on its own after the bypassed panel bands
+        {
+            const std::array<std::pair<const char*, BandSpec>, 5> types
+            {{
+                { "band-lowshelf",  makeBand(BandType::LowShelf,  200.f,  0.71f,  6.f) },
+                { "band-highshelf", makeBand(BandType::HighShelf, 6000.f, 0.71f, -6.f) },
+                { "band-notch",     makeBand(BandType::Notch,     1000.f, 4.f,    0.f) },
+                { "band-bandpass",  makeBand(BandType::BandPass,  2000.f, 1.f,    0.f) },
+                { "band-tilt",      makeBand(BandType::Tilt,      1000.f, 0.71f,  6.f) },
+            }};
+
+            for (const auto& [name, band] : types)
+            {
+                auto settings = base;
+                setBypassed(settings, allBands);
+
+                Configuration configuration{ name, settings };
+                configuration.extraBands = { band };
+                configurations.push_back(configuration);
+            }
+        }
+
+        // the bank full: the six panel bands and 18 more of every type
+        {
+            Configuration configuration{ "bands-24", base, { 44100.0, primarySampleRate, 96000.0 } };
+
+            for (int i = 0; i < FilterEngine::maxExtraBands; ++i)
+            {
+                const auto type = static_cast<BandType>(i % ((int)BandType::HighCut + 1));
+                const auto freq = 30.f * std::pow(2.f, (float)i * 0.5f);
+                const auto gain = (i % 3 - 1) * 4.f;
+
+                configuration.extraBands.push_back(makeBand(type, freq, 0.5f + 0.25f * (float)(i % 4), gain, 2 + 2 * (i % 4)));
+            }
+
+            configurations.push_back(configuration);
+        }
+
+        return configurations;
+    }
+
+    // xorshift32, so the noise doesn't depend on how juce::Random happens to be implemented
+    struct NoiseSource
+    {
+        juce::uint32 state = 0x53455121;   // fixed seed: the golden files depend on it
+
+        float next()
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            return (float)((double)state / 4294967296.0 * 2.0 - 1.0);
+        }
+    };
+
+    std::vector<Stimulus> makeStimuli(double sampleRate, int numSamples)
+    {
+        std::vector<Stimulus> stimuli;
+        const auto pi = juce::MathConstants<double>::pi;
+
+        auto add = [&](const char* name, auto&& generate)
+        {
+            Stimulus stimulus;
+            stimulus.name = name;
+
+            auto& left = stimulus.channels[0];
+            left.resize((size_t)numSamples);
+
+            for (int n = 0; n < numSamples; ++n)
+                left[(size_t)n] = generate(n);
+
+            // the right channel is the left one quieter and later, so mid and side both carry signal
+            constexpr int delay = 37;
+            auto& right = stimulus.channels[1];
+            right.assign((size_t)numSamples, 0.f);
+
+            for (int n = delay; n < numSamples; ++n)
+                right[(size_t)n] = 0.7f * left[(size_t)(n - delay)];
+
+            stimuli.push_back(std::move(stimulus));
+        };
+
+        add("impulse", [](int n) { return n == 0 ? 1.f : 0.f; });
+        add("dc", [](int) { return 0.5f; });
+
+        {
+            // exponential sweep from 20 Hz to 90% of Nyquist
+            const auto f0 = 20.0;
+            const auto f1 = sampleRate * 0.45;
+            const auto duration = numSamples / sampleRate;
+            const auto k = std::log(f1 / f0);
+
+            add("sweep", [=](int n)
+            {
+                const auto t = n / sampleRate;
+                const auto phase = 2.0 * pi * f0 * duration / k * (std::exp(t / duration * k) - 1.0);
+                return (float)(0.5 * std::sin(phase));
+            });
+        }
+
+        {
+            NoiseSource noise;
+            add("noise", [&noise](int) { return 0.5f * noise.next(); });
+        }
+
+        {
+            const auto freq = sampleRate * 0.49;
+            add("near-nyquist", [=](int n) { return (float)(0.5 * std::sin(2.0 * pi * freq * n / sampleRate)); });
+        }
+
+        return stimuli;
+    }
+
+    double millisecondsSince(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    }
+
+    //==============================================================================
+    // FilterEngine as the processor runs it: the settings and extra bands applied before every block
+    struct EnginePath
+    {
+        std::unique_ptr<FilterEngine> engine = std::make_unique<FilterEngine>();
+        const Configuration* configuration = nullptr;
+
+        void prepare(double sampleRate, const Configuration& newConfiguration)
+        {
+            configuration = &newConfiguration;
+            engine->prepare(sampleRate);
+        }
+
+        void process(juce::dsp::AudioBlock<float> block)
+        {
+            engine->update(configuration->settings);
+            engine->setExtraBands(configuration->extraBands.data(), (int)configuration->extraBands.size());
+            engine->process(block);
+        }
+    };
+
+    /*
+     the baseline processor's filter path: a MonoChain per channel, designed with
+     IIR::Coefficients and FilterDesign as the baseline's updateFilters() did. the
+     extra bands run after it, as IIR::Filters designed by the matching JUCE calls
+     */
+    struct BaselinePath
+    {
+        using Filter = juce::dsp::IIR::Filter<float>;
+        using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+        using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, Filter, Filter, Filter, CutFilter>;
+
+        std::array<MonoChain, 2> chains;
+        std::array<std::vector<Filter>, 2> extraFilters;
+
+        // the baseline had no routing and no dynamics
+        static bool canRender(const Configuration& configuration)
+        {
+            const auto& settings = configuration.settings;
+
+            for (const auto& band : makePeakBandSettings(settings))
+                if (band.dynamics.ratio > 1.f)
+                    return false;
+
+            return settings.lowCutRouting == Routing_Stereo && settings.lowPeakRouting == Routing_Stereo
+                && settings.lowMidPeakRouting == Routing_Stereo && settings.highMidPeakRouting == Routing_Stereo
+                && settings.highPeakRouting == Routing_Stereo && settings.highCutRouting == Routing_Stereo;
+        }
+
+        // the JUCE design of any band type, one set of coefficients per second-order section
+        static std::vector<Filter::CoefficientsPtr> design(const BandSpec& spec, double sampleRate)
+        {
+            using Coefficients = juce::dsp::IIR::Coefficients<float>;
+            auto gain = [](float decibels) { return juce::Decibels::decibelsToGain(decibels); };
+
+            switch (spec.type)
+            {
+                case BandType::Peak:      return { Coefficients::makePeakFilter(sampleRate, spec.freq, spec.quality, gain(spec.gainInDecibels)) };
+                case BandType::LowShelf:  return { Coefficients::makeLowShelf(sampleRate, spec.freq, spec.quality, gain(spec.gainInDecibels)) };
+                case BandType::HighShelf: return { Coefficients::makeHighShelf(sampleRate, spec.freq, spec.quality, gain(spec.gainInDecibels)) };
+                case BandType::Notch:     return { Coefficients::makeNotch(sampleRate, spec.freq, spec.quality) };
+                case BandType::BandPass:  return { Coefficients::makeBandPass(sampleRate, spec.freq, spec.quality) };
+
+                case BandType::Tilt:
+                    return { Coefficients::makeLowShelf(sampleRate, spec.freq, spec.quality, gain(-0.5f * spec.gainInDecibels)),
+                             Coefficients::makeHighShelf(sampleRate, spec.freq, spec.quality, gain(0.5f * spec.gainInDecibels)) };
+
+                case BandType::LowCut:
+                case BandType::HighCut:
+                {
+                    auto designed = spec.type == BandType::LowCut
+                                  ? juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(spec.freq, sampleRate, spec.order)
+                                  : juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(spec.freq, sampleRate, spec.order);
+
+                    std::vector<Filter::CoefficientsPtr> sections;
+                    for (int i = 0; i < (int)designed.size(); ++i)
+                        sections.push_back(designed[i]);
+
+                    return sections;
+                }
+            }
+
+            jassertfalse;
+            return {};
+        }
+
+        // the baseline's updateCutFilter(): the first slope + 1 stages, the rest bypassed
+        template<int Stage>
+        static void updateCutStage(CutFilter& cut, const std::vector<Filter::CoefficientsPtr>& sections)
+        {
+            const auto used = Stage < (int)sections.size();
+            cut.template setBypassed<Stage>(!used);
+
+            if (used)
+                *cut.template get<Stage>().coefficients = *sections[(size_t)Stage];
+        }
+
+        static void updateCutFilter(CutFilter& cut, const std::vector<Filter::CoefficientsPtr>& sections)
+        {
+            updateCutStage<0>(cut, sections);
+            updateCutStage<1>(cut, sections);
+            updateCutStage<2>(cut, sections);
+            updateCutStage<3>(cut, sections);
+        }
+
+        template<int Position>
+        void updatePeakFilter(const std::vector<Filter::CoefficientsPtr>& sections, bool bypassed)
+        {
+            for (auto& chain : chains)
+            {
+                chain.template setBypassed<Position>(bypassed);
+                *chain.template get<Position>().coefficients = *sections.front();
+            }
+        }
+
+        void prepare(double sampleRate, const Configuration& configuration)
+        {
+            jassert(canRender(configuration));
+
+            const auto bands = makePanelBands(configuration.settings);
+            const auto bypassed = makePanelBypassed(configuration.settings);
+            const juce::dsp::ProcessSpec spec{ sampleRate, (juce::uint32)GoldenRender::blockSize, 1 };
+
+            for (auto& chain : chains)
+            {
+                chain.prepare(spec);
+
+                chain.setBypassed<LowCut>(bypassed[LowCut]);
+                updateCutFilter(chain.get<LowCut>(), design(bands[LowCut], sampleRate));
+
+                chain.setBypassed<HighCut>(bypassed[HighCut]);
+                updateCutFilter(chain.get<HighCut>(), design(bands[HighCut], sampleRate));
+            }
+
+            updatePeakFilter<LowPeak>(design(bands[LowPeak], sampleRate), bypassed[LowPeak]);
+            updatePeakFilter<LowMidPeak>(design(bands[LowMidPeak], sampleRate), bypassed[LowMidPeak]);
+            updatePeakFilter<HighMidPeak>(design(bands[HighMidPeak], sampleRate), bypassed[HighMidPeak]);
+            updatePeakFilter<HighPeak>(design(bands[HighPeak], sampleRate), bypassed[HighPeak]);
+
+            for (auto& filters : extraFilters)
+            {
+                filters.clear();
+
+                for (const auto& band : configuration.extraBands)
+                {
+                    for (auto& sections : design(band, sampleRate))
+                    {
+                        filters.emplace_back();
+                        filters.back().coefficients = sections;
+                        filters.back().prepare(spec);
+                    }
+                }
+            }
+        }
+
+        void process(juce::dsp::AudioBlock<float> block)
+        {
+            for (size_t ch = 0; ch < chains.size(); ++ch)
+            {
+                auto channelBlock = block.getSingleChannelBlock(ch);
+                juce::dsp::ProcessContextReplacing<float> context(channelBlock);
+
+                chains[ch].process(context);
+
+                for (auto& filter : extraFilters[ch])
+                    filter.process(context);
+            }
+        }
+    };
+
+    //==============================================================================
+    // every stimulus in turn, each from a freshly prepared path: per stimulus, left then right
+    template<typename Path>
+    std::vector<float> render(Path& path, const Configuration& configuration, const std::vector<Stimulus>& stimuli,
+                              double sampleRate, double& milliseconds)
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        std::vector<float> output;
+        juce::AudioBuffer<float> buffer(2, GoldenRender::numSamples);
+
+        milliseconds = 0.0;
+
+        for (const auto& stimulus : stimuli)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                buffer.copyFrom(ch, 0, stimulus.channels[(size_t)ch].data(), GoldenRender::numSamples);
+
+            path.prepare(sampleRate, configuration);
+
+            juce::dsp::AudioBlock<float> block(buffer);
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int first = 0; first < GoldenRender::numSamples; first += GoldenRender::blockSize)
+            {
+                const auto length = juce::jmin(GoldenRender::blockSize, GoldenRender::numSamples - first);
+                path.process(block.getSubBlock((size_t)first, (size_t)length));
+            }
+
+            milliseconds += millisecondsSince(start);
+
+            for (int ch = 0; ch < 2; ++ch)
+                output.insert(output.end(), buffer.getReadPointer(ch), buffer.getReadPointer(ch) + GoldenRender::numSamples);
+        }
+
+        return output;
+    }
+
+    void measureError(const std::vector<float>& a, const std::vector<float>& b, double& maxAbs, double& rms)
+    {
+        jassert(a.size() == b.size());
+
+        maxAbs = 0.0;
+        auto sumOfSquares = 0.0;
+
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            const auto error = std::abs((double)a[i] - (double)b[i]);
+
+            // a NaN would compare as no error at all
+            if (!std::isfinite(error))
+            {
+                maxAbs = rms = std::numeric_limits<double>::infinity();
+                return;
+            }
+
+            maxAbs = juce::jmax(maxAbs, error);
+            sumOfSquares += error * error;
+        }
+
+        rms = a.empty() ? 0.0 : std::sqrt(sumOfSquares / (double)a.size());
+    }
+
+    bool isWithin(const GoldenRender::Tolerance& tolerance, double maxAbs, double rms, double recordedMaxAbs)
+    {
+        switch (tolerance.mode)
+        {
+            case GoldenRender::Tolerance::Mode::Recorded: return maxAbs <= recordedMaxAbs + tolerance.recordedMargin;
+            case GoldenRender::Tolerance::Mode::BitExact: return maxAbs == 0.0;
+            case GoldenRender::Tolerance::Mode::MaxAbs:   return maxAbs <= tolerance.maxAbsError;
+            case GoldenRender::Tolerance::Mode::Rms:      return rms <= tolerance.rmsError;
+        }
+
+        return false;
+    }
+
+    // "<golden file> <max abs>" per line: how far FilterEngine was from each golden when it was recorded
+    const char* const recordedErrorFileName = "recorded-error.txt";
+
+    std::map<juce::String, double> readRecordedErrors(const juce::File& directory)
+    {
+        std::map<juce::String, double> errors;
+        juce::StringArray lines;
+        lines.addLines(directory.getChildFile(recordedErrorFileName).loadFileAsString());
+
+        for (const auto& line : lines)
+        {
+            if (line.startsWith("#") || line.trim().isEmpty())
+                continue;
+
+            errors[line.upToFirstOccurrenceOf(" ", false, false)] = line.fromFirstOccurrenceOf(" ", false, false).getDoubleValue();
+        }
+
+        return errors;
+    }
+
+    bool writeRecordedErrors(const juce::File& directory, const std::map<juce::String, double>& errors)
+    {
+        juce::String text("# max abs difference between FilterEngine and each golden when it was recorded\n");
+
+        for (const auto& [name, error] : errors)
+            text << name << " " << juce::String(error, 9) << "\n";
+
+        return directory.getChildFile(recordedErrorFileName).replaceWithText(text);
+    }
+
+    // little endian float32, no header: the file name carries everything else
+    bool readGolden(const juce::File& file, size_t numValues, std::vector<float>& values)
+    {
+        juce::FileInputStream stream(file);
+
+        if (!stream.openedOk() || stream.getTotalLength() != (juce::int64)(numValues * sizeof(float)))
+            return false;
+
+        values.resize(numValues);
+        for (auto& value : values)
+            value = stream.readFloat();
+
+        return true;
+    }
+
+    bool writeGolden(const juce::File& file, const std::vector<float>& values)
+    {
+        // a render that blew up is a failure, not a reference
+        if (!std::all_of(values.begin(), values.end(), [](float v) { return std::isfinite(v); }))
+            return false;
+
+        file.deleteFile();
+        juce::FileOutputStream stream(file);
+
+        if (!stream.openedOk())
+            return false;
+
+        for (auto value : values)
+            stream.writeFloat(value);
+
+        return true;
+    }
+}
+
+std::vector<GoldenRender::Result> GoldenRender::run(const Options& options)
+{
+    std::vector<Result> results;
+
+    if (options.recordMissing || options.recordAll)
+        options.goldenDirectory.createDirectory();
+
+    auto recordedErrors = readRecordedErrors(options.goldenDirectory);
+    auto recordedAny = false;
+
+    // one of each path, prepared again for every render, as a host re-prepares the processor
+    EnginePath engine;
+    BaselinePath baseline;
+
+    for (const auto& configuration : makeConfigurations())
+    {
+        const auto hasBaseline = BaselinePath::canRender(configuration);
+
+        for (auto sampleRate : configuration.sampleRates)
+        {
+            Result result;
+            result.configuration = configuration.name;
+            result.sampleRate = sampleRate;
+
+            const auto stimuli = makeStimuli(sampleRate, numSamples);
+            const auto output = render(engine, configuration, stimuli, sampleRate, result.milliseconds);
+
+            std::vector<float> reference;
+
+            if (hasBaseline)
+            {
+                double unused = 0.0, baselineMilliseconds = 0.0;
+                reference = render(baseline, configuration, stimuli, sampleRate, baselineMilliseconds);
+                measureError(reference, output, result.baselineMaxAbs, unused);
+            }
+
+            const auto file = options.goldenDirectory.getChildFile(configuration.name + "_"
+                                                                   + juce::String(juce::roundToInt(sampleRate)) + ".f32");
+            const auto fileName = file.getFileName();
+
+            std::vector<float> golden;
+            if (options.recordAll || !readGolden(file, output.size(), golden))
+            {
+                // unless it's recorded now, not passed: there's nothing to compare against
+                if ((options.recordAll || options.recordMissing) && writeGolden(file, hasBaseline ? reference : output))
+                {
+                    result.recorded = true;
+                    golden = hasBaseline ? reference : output;
+                }
+                else
+                {
+                    results.push_back(result);
+                    continue;
+                }
+            }
+
+            measureError(golden, output, result.maxAbs, result.rms);
+
+            if (result.recorded)
+            {
+                recordedErrors[fileName] = result.maxAbs;
+                recordedAny = true;
+            }
+
+            // a freshly recorded golden is checked too, in the modes with a fixed threshold
+            const auto recordedError = recordedErrors.count(fileName) != 0 ? recordedErrors[fileName] : 0.0;
+            result.passed = isWithin(options.tolerance, result.maxAbs, result.rms, recordedError);
+
+            results.push_back(result);
+        }
+    }
+
+    if (recordedAny && !writeRecordedErrors(options.goldenDirectory, recordedErrors))
+        for (auto& result : results)
+            result.passed = result.passed && !result.recorded;
+
+    return results;
+}
+
+bool GoldenRender::allPassed(const std::vector<Result>& results)
+{
+    return !results.empty() && std::all_of(results.begin(), results.end(), [](const Result& r) { return r.passed; });
+}
+
+juce::String GoldenRender::formatReport(const std::vector<Result>& results, const Tolerance& tolerance)
+{
+    juce::String report;
+    int numFailed = 0, numRecorded = 0;
+    double totalMilliseconds = 0.0;
+
+    double worstBaselineMaxAbs = 0.0;
+
+    report << "configuration, rate, max abs, rms, vs baseline, ms, status\n";
+
+    for (const auto& r : results)
+    {
+        report << r.configuration << ", " << juce::roundToInt(r.sampleRate) << ", "
+               << juce::String(r.maxAbs, 9) << ", " << juce::String(r.rms, 9) << ", "
+               << (r.baselineMaxAbs < 0.0 ? juce::String("-") : juce::String(r.baselineMaxAbs, 9)) << ", "
+               << juce::String(r.milliseconds, 3) << ", "
+               << (r.recorded ? (r.passed ? "recorded" : "recorded, FAILED") : (r.passed ? "ok" : "FAILED")) << "\n";
+
+        numFailed += r.passed ? 0 : 1;
+        numRecorded += r.recorded ? 1 : 0;
+        totalMilliseconds += r.milliseconds;
+        worstBaselineMaxAbs = juce::jmax(worstBaselineMaxAbs, r.baselineMaxAbs);
+    }
+
+    const auto modeName = tolerance.mode == Tolerance::Mode::Recorded ? "as recorded + " + juce::String(tolerance.recordedMargin)
+                        : tolerance.mode == Tolerance::Mode::BitExact ? juce::String("bit exact")
+                        : tolerance.mode == Tolerance::Mode::MaxAbs   ? "max abs <= " + juce::String(tolerance.maxAbsError)
+                                                                      : "rms <= " + juce::String(tolerance.rmsError);
+
+    report << "\n" << (int)results.size() << " renders, " << numFailed << " failed, " << numRecorded << " recorded"
+           << " (tolerance: " << modeName << ")\n"
+           << "largest difference from the baseline: " << juce::String(worstBaselineMaxAbs, 9) << "\n"
+           << juce::String(totalMilliseconds, 1) << " ms rendering\n";
+
+    return report;
+}
+
+//==============================================================================
+std::vector<GoldenRender::Throughput> GoldenRender::measureThroughput(double audioSeconds)
+{
+    std::vector<Throughput> results;
+
+    const auto sampleRate = primarySampleRate;
+    const auto numSamples = juce::jmax(blockSize, (int)(audioSeconds * sampleRate));
+
+    // one long noise stimulus, and a copy of it to filter
+    juce::AudioBuffer<float> input(2, numSamples), buffer(2, numSamples);
+    NoiseSource noise;
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int n = 0; n < numSamples; ++n)
+            input.getWritePointer(ch)[n] = 0.5f * noise.next();
+
+    auto time = [&](auto& path, const Configuration& configuration)
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        for (int ch = 0; ch < 2; ++ch)
+            buffer.copyFrom(ch, 0, input, ch, 0, numSamples);
+
+        path.prepare(sampleRate, configuration);
+
+        juce::dsp::AudioBlock<float> block(buffer);
+        const auto start = juce::Time::getHighResolutionTicks();
+
+        for (int first = 0; first < numSamples; first += blockSize)
+            path.process(block.getSubBlock((size_t)first, (size_t)juce::jmin(blockSize, numSamples - first)));
+
+        return millisecondsSince(start);
+    };
+
+    EnginePath engine;
+    BaselinePath baseline;
+
+    // the panel at its steepest, the bank full, and every peak dynamic
+    const juce::StringArray names{ "slope48-bypass00", "bands-24", "dynamic-all" };
+
+    for (const auto& configuration : makeConfigurations())
+    {
+        if (!names.contains(configuration.name))
+            continue;
+
+        Throughput result;
+        result.configuration = configuration.name;
+        result.audioSeconds = numSamples / sampleRate;
+        result.milliseconds = time(engine, configuration);
+
+        if (BaselinePath::canRender(configuration))
+            result.baselineMilliseconds = time(baseline, configuration);
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+juce::String GoldenRender::formatThroughput(const std::vector<Throughput>& results)
+{
+    juce::String report;
+    report << "configuration, audio s, engine ms, baseline ms, engine x realtime\n";
+
+    for (const auto& r : results)
+    {
+        report << r.configuration << ", " << juce::String(r.audioSeconds, 1) << ", "
+               << juce::String(r.milliseconds, 1) << ", "
+               << (r.baselineMilliseconds < 0.0 ? juce::String("-") : juce::String(r.baselineMilliseconds, 1)) << ", "
+               << juce::String(r.audioSeconds * 1000.0 / juce::jmax(1.0e-3, r.milliseconds), 0) << "\n";
+    }
+
+    return report;
+}
@@ -0,0 +1,225 @@
+/*
+  ==============================================================================
+
+    LevelMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LevelMeter.h"
+
+BlockLevels measureLevels(const float* samples, int numSamples)
+{
+    float minimum = 0.f, maximum = 0.f, sumOfSquares = 0.f;
+    int numClips = 0;
+
+    auto measureSample = [&](float x)
+    {
+        minimum = juce::jmin(minimum, x);
+        maximum = juce::jmax(maximum, x);
+        sumOfSquares += x * x;
+        numClips += std::abs(x) >= meterClipLevel ? 1 : 0;
+    };
+
+    int i = 0;
+
+   #if JUCE_USE_SIMD
+    using Register = juce::dsp::SIMDRegister<float>;
+    constexpr auto width = (int)Register::SIMDNumElements;
+
+    // loads have to be aligned, so whatever comes before the first aligned sample goes one at a time
+    for (; i < numSamples && !Register::isSIMDAligned(samples + i); ++i)
+        measureSample(samples[i]);
+
+    if (numSamples - i >= width)
+    {
+        const auto zero = Register::expand(0.f);
+        const auto one = Register::expand(1.f);
+        const auto clipHigh = Register::expand(meterClipLevel);
+        const auto clipLow = Register::expand(-meterClipLevel);
+
+        auto lanesMin = zero, lanesMax = zero, lanesSquares = zero, lanesClips = zero;
+
+        for (; i + width <= numSamples; i += width)
+        {
+            const auto x = Register::fromRawArray(samples + i);
+
+            lanesMin = Register::min(lanesMin, x);
+            lanesMax = Register::max(lanesMax, x);
+            lanesSquares += x * x;
+            lanesClips += one & (Register::greaterThanOrEqual(x, clipHigh) | Register::lessThanOrEqual(x, clipLow));
+        }
+
+        for (size_t lane = 0; lane < Register::size(); ++lane)
+        {
+            minimum = juce::jmin(minimum, lanesMin.get(lane));
+            maximum = juce::jmax(maximum, lanesMax.get(lane));
+        }
+
+        sumOfSquares += lanesSquares.sum();
+        numClips += (int)lanesClips.sum();
+    }
+   #endif
+
+    for (; i < numSamples; ++i)
+        measureSample(samples[i]);
+
+    BlockLevels levels;
+    levels.peak = juce::jmax(-minimum, maximum);
+    levels.sumOfSquares = sumOfSquares;
+    levels.numClips = numClips;
+    return levels;
+}
+
+//==============================================================================
+void LevelMeterSource::reset()
+{
+    const auto resets = totals.resetCount + 1;
+
+    totals = {};
+    totals.resetCount = resets;
+
+    sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    resetCount.store(resets, std::memory_order_relaxed);
+    numSamples.store(0, std::memory_order_relaxed);
+    numBlocks.store(0, std::memory_order_relaxed);
+
+    for (int ch = 0; ch < numMeterChannels; ++ch)
+    {
+        sumOfSquares[(size_t)ch].store(0.0, std::memory_order_relaxed);
+        numClips[(size_t)ch].store(0, std::memory_order_relaxed);
+    }
+
+    sequence.fetch_add(1, std::memory_order_release);
+}
+
+void LevelMeterSource::publish(const std::array<BlockLevels, numMeterChannels>& levels, int numBlockSamples)
+{
+    // the peaks go first: a reader only looks at blocks the totals below already count
+    auto& blockPeaks = peaks[(size_t)(totals.numBlocks % peakHistory)];
+
+    for (int ch = 0; ch < numMeterChannels; ++ch)
+    {
+        const auto& channel = levels[(size_t)ch];
+
+        blockPeaks[(size_t)ch].store(channel.peak, std::memory_order_relaxed);
+        totals.sumOfSquares[(size_t)ch] += channel.sumOfSquares;
+        totals.numClips[(size_t)ch] += (juce::uint64)channel.numClips;
+    }
+
+    totals.numSamples += (juce::uint64)numBlockSamples;
+    ++totals.numBlocks;
+
+    sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    numSamples.store(totals.numSamples, std::memory_order_relaxed);
+    numBlocks.store(totals.numBlocks, std::memory_order_relaxed);
+
+    for (int ch = 0; ch < numMeterChannels; ++ch)
+    {
+        sumOfSquares[(size_t)ch].store(totals.sumOfSquares[(size_t)ch], std::memory_order_relaxed);
+        numClips[(size_t)ch].store(totals.numClips[(size_t)ch], std::memory_order_relaxed);
+    }
+
+    sequence.fetch_add(1, std::memory_order_release);
+}
+
+LevelMeterSource::Reading LevelMeterSource::read(Reader& reader) const
+{
+    Reader now;
+
+    for (;;)
+    {
+        const auto before = sequence.load(std::memory_order_acquire);
+
+        if ((before & 1) != 0)
+            continue;
+
+        now.resetCount = resetCount.load(std::memory_order_relaxed);
+        now.numSamples = numSamples.load(std::memory_order_relaxed);
+        now.numBlocks = numBlocks.load(std::memory_order_relaxed);
+
+        for (int ch = 0; ch < numMeterChannels; ++ch)
+        {
+            now.sumOfSquares[(size_t)ch] = sumOfSquares[(size_t)ch].load(std::memory_order_relaxed);
+            now.numClips[(size_t)ch] = numClips[(size_t)ch].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sequence.load(std::memory_order_relaxed) == before)
+            break;
+    }
+
+    Reading reading;
+
+    // the first read, or the source was reset since: start counting from here
+    if (now.resetCount != reader.resetCount)
+    {
+        reader = now;
+        return reading;
+    }
+
+    reading.numSamples = (int)(now.numSamples - reader.numSamples);
+
+    for (int ch = 0; ch < numMeterChannels; ++ch)
+    {
+        const auto sum = now.sumOfSquares[(size_t)ch] - reader.sumOfSquares[(size_t)ch];
+
+        reading.meanSquare[(size_t)ch] = reading.numSamples > 0 ? (float)juce::jmax(0.0, sum / reading.numSamples) : 0.f;
+        reading.numClips[(size_t)ch] = (int)(now.numClips[(size_t)ch] - reader.numClips[(size_t)ch]);
+    }
+
+    // a reader that fell more than peakHistory blocks behind gets the most recent ones
+    const auto firstBlock = juce::jmax(reader.numBlocks, now.numBlocks > (juce::uint64)peakHistory ? now.numBlocks - peakHistory : 0);
+
+    for (auto block = firstBlock; block < now.numBlocks; ++block)
+    {
+        const auto& blockPeaks = peaks[(size_t)(block % peakHistory)];
+
+        for (int ch = 0; ch < numMeterChannels; ++ch)
+            reading.peak[(size_t)ch] = juce::jmax(reading.peak[(size_t)ch], blockPeaks[(size_t)ch].load(std::memory_order_relaxed));
+    }
+
+    reader = now;
+    return reading;
+}
+
+//==============================================================================
+void LevelMeterBallistics::update(const LevelMeterSource::Reading& reading, double sampleRate)
+{
+    if (reading.numSamples == 0)
+        return;
+
+    const auto seconds = (float)(reading.numSamples / juce::jmax(1.0, sampleRate));
+    const auto rmsCoefficient = 1.f - std::exp(-seconds / rmsSeconds);
+
+    for (size_t ch = 0; ch < (size_t)numMeterChannels; ++ch)
+    {
+        const auto newPeakDb = juce::Decibels::gainToDecibels(reading.peak[ch], floorDb);
+
+        peakDb[ch] = juce::jmax(newPeakDb, peakDb[ch] - releaseDbPerSecond * seconds, floorDb);
+
+        if (newPeakDb >= holdDb[ch])
+        {
+            holdDb[ch] = newPeakDb;
+            holdSecondsLeft[ch] = holdSeconds;
+        }
+        else if ((holdSecondsLeft[ch] -= seconds) < 0.f)
+        {
+            holdDb[ch] = juce::jmax(peakDb[ch], holdDb[ch] + holdSecondsLeft[ch] * releaseDbPerSecond, floorDb);
+            holdSecondsLeft[ch] = 0.f;
+        }
+
+        meanSquare[ch] += rmsCoefficient * (reading.meanSquare[ch] - meanSquare[ch]);
+        numClips[ch] += reading.numClips[ch];
+    }
+}
+
+float LevelMeterBallistics::getRmsDb(int channel) const
+{
+    return juce::Decibels::gainToDecibels(std::sqrt(meanSquare[(size_t)channel]), floorDb);
+}
@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    LevelMeter.h
+
+    Input and output peak, RMS and clip metering. The audio thread makes one
+    pass over each channel per block and publishes raw totals; readers on any
+    thread turn them into meter readings with their own ballistics.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+
+enum MeterChannel
+{
+    InputLeft,
+    InputRight,
+    OutputLeft,
+    OutputRight,
+    numMeterChannels
+};
+
+// |x| at or above this counts as a clipped sample
+static constexpr float meterClipLevel = 1.f;
+
+struct BlockLevels
+{
+    float peak = 0.f;
+    float sumOfSquares = 0.f;
+    int numClips = 0;
+};
+
+/*
+ min, max, sum of squares and clip count in one pass, a SIMD register of samples at a
+ time with lane-wise accumulators that are only combined at the end. written out with
+ SIMDRegister because compilers don't reliably vectorise the mix of min/max and sums.
+ */
+BlockLevels measureLevels(const float* samples, int numSamples);
+
+/*
+ one writer, the audio thread, and any number of readers. the totals only ever
+ grow and are published under a sequence counter, so each reader keeps the totals
+ it saw last and gets everything since from the difference. block peaks can't be
+ summed, so they go into a ring of the last peakHistory blocks instead.
+ */
+struct LevelMeterSource
+{
+    static constexpr int peakHistory = 256;
+
+    // audio thread, or while it is stopped
+    void reset();
+    void publish(const std::array<BlockLevels, numMeterChannels>& levels, int numSamples);
+
+    struct Reader
+    {
+        juce::uint64 numSamples = 0, numBlocks = 0;
+        juce::uint32 resetCount = 0;
+        std::array<double, numMeterChannels> sumOfSquares{};
+        std::array<juce::uint64, numMeterChannels> numClips{};
+    };
+
+    // everything since reader's last read
+    struct Reading
+    {
+        int numSamples = 0;
+        std::array<float, numMeterChannels> peak{}, meanSquare{};
+        std::array<int, numMeterChannels> numClips{};
+    };
+
+    Reading read(Reader& reader) const;
+
+private:
+    std::atomic<juce::uint32> sequence{ 0 };
+
+    std::atomic<juce::uint32> resetCount{ 0 };
+    std::atomic<juce::uint64> numSamples{ 0 }, numBlocks{ 0 };
+    std::array<std::atomic<double>, numMeterChannels> sumOfSquares{};
+    std::array<std::atomic<juce::uint64>, numMeterChannels> numClips{};
+
+    std::array<std::array<std::atomic<float>, numMeterChannels>, peakHistory> peaks{};
+
+    // the writer's own copy of the totals
+    Reader totals;
+};
+
+/*
+ meter ballistics for a reader: peaks attack instantly and fall at releaseDbPerSecond
+ after holding for holdSeconds, RMS is averaged with an rmsSeconds time constant.
+ clips add up until resetClips().
+ */
+struct LevelMeterBallistics
+{
+    static constexpr float floorDb = -100.f;
+    static constexpr float releaseDbPerSecond = 20.f;
+    static constexpr float holdSeconds = 1.5f;
+    static constexpr float rmsSeconds = 0.3f;
+
+    void update(const LevelMeterSource::Reading& reading, double sampleRate);
+
+    float getPeakDb(int channel) const { return peakDb[(size_t)channel]; }
+    float getPeakHoldDb(int channel) const { return holdDb[(size_t)channel]; }
+    float getRmsDb(int channel) const;
+    int getNumClips(int channel) const { return numClips[(size_t)channel]; }
+
+    void resetClips() { numClips.fill(0); }
+
+private:
+    std::array<float, numMeterChannels> peakDb{ floorDb, floorDb, floorDb, floorDb };
+    std::array<float, numMeterChannels> holdDb{ floorDb, floorDb, floorDb, floorDb };
+    std::array<float, numMeterChannels> holdSecondsLeft{}, meanSquare{};
+    std::array<int, numMeterChannels> numClips{};
+};
@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    MultiResolutionAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "MultiResolutionAnalyzer.h"
+
+namespace
+{
+    // the odd taps at offsets 1, 3 and 5 from the centre, which is 0.5
+    constexpr float halfBandTaps[] = { 0.3016132610f, -0.0638719463f, 0.0130559512f };
+}
+
+void HalfBandDecimator::reset()
+{
+    work.fill(0.f);
+    phase = 0;
+}
+
+int HalfBandDecimator::process(const float* input, int numSamples, float* output)
+{
+    int numOutput = 0;
+
+    while (numSamples > 0)
+    {
+        const auto chunk = juce::jmin(numSamples, chunkSize);
+
+        std::copy(input, input + chunk, work.begin() + historySize);
+
+        // output i uses the window that ends on the chunk's i-th sample, centred historySize / 2 earlier
+        for (int i = phase; i < chunk; i += 2)
+        {
+            const auto* x = work.data() + i;
+
+            output[numOutput++] = 0.5f * x[5]
+                                + halfBandTaps[0] * (x[4] + x[6])
+                                + halfBandTaps[1] * (x[2] + x[8])
+                                + halfBandTaps[2] * (x[0] + x[10]);
+        }
+
+        phase = (phase + chunk) & 1;
+
+        std::copy(work.begin() + chunk, work.begin() + chunk + historySize, work.begin());
+
+        input += chunk;
+        numSamples -= chunk;
+    }
+
+    return numOutput;
+}
+
+//==============================================================================
+void MultiResolutionAnalyzer::prepare(int fftOrder)
+{
+    order = fftOrder;
+
+    const auto fftSize = 1 << order;
+
+    // the same engine and window as the single resolution analyzer at this order
+    resources = FFTResourceCache::acquire(order, juce::dsp::WindowingFunction<float>::blackmanHarris);
+
+    fftData.assign((size_t)fftSize * 2, 0.f);
+
+    for (auto& level : levels)
+    {
+        level.decimator.reset();
+        level.samples.assign((size_t)fftSize, 0.f);
+        level.spectrum.assign((size_t)fftSize / 2, -48.f);
+        level.samplesSinceTransform = 0;
+    }
+
+    setNormalisation(normalisation);
+
+    fftDataFifo.prepare((size_t)getFFTSize() / 2);
+}
+
+void MultiResolutionAnalyzer::setNormalisation(Normalisation newNormalisation)
+{
+    normalisation = newNormalisation;
+
+    const auto hop = (1 << order) / 8;
+
+    for (int k = 0; k < numLevels; ++k)
+    {
+        auto& level = levels[(size_t)k];
+
+        // power per bin scales with the bin width, so level k's magnitudes are sqrt(2^k) short on noise
+        level.gain = normalisation == Normalisation::Noise ? std::sqrt(float(1 << k)) : 1.f;
+
+        // the spectra held for the stitch are in the old normalisation until then
+        level.samplesSinceTransform = juce::jmax(level.samplesSinceTransform, hop);
+    }
+}
+
+void MultiResolutionAnalyzer::append(Level& level, const float* newSamples, int numSamples)
+{
+    auto& samples = level.samples;
+    const auto size = (int)samples.size();
+
+    if (numSamples >= size)
+    {
+        std::copy(newSamples + numSamples - size, newSamples + numSamples, samples.begin());
+    }
+    else
+    {
+        std::copy(samples.begin() + numSamples, samples.end(), samples.begin());
+        std::copy(newSamples, newSamples + numSamples, samples.end() - numSamples);
+    }
+
+    level.samplesSinceTransform += numSamples;
+}
+
+void MultiResolutionAnalyzer::pushSamples(const float* samples, int numSamples, float negativeInfinity)
+{
+    if (resources == nullptr || numSamples <= 0)
+        return;
+
+    // the decimators take the block in pieces, so the scratch buffers never grow with the host's block size
+    constexpr int piece = 1024;
+
+    for (auto& buffer : decimated)
+        if (buffer.size() < (size_t)piece / 2 + 1)
+            buffer.resize((size_t)piece / 2 + 1);
+
+    for (int start = 0; start < numSamples; start += piece)
+    {
+        const float* input = samples + start;
+        auto numInput = juce::jmin(piece, numSamples - start);
+
+        append(levels[0], input, numInput);
+
+        for (int k = 1; k < numLevels && numInput > 0; ++k)
+        {
+            auto& output = decimated[k & 1];
+
+            numInput = levels[(size_t)k].decimator.process(input, numInput, output.data());
+            input = output.data();
+
+            append(levels[(size_t)k], input, numInput);
+        }
+    }
+
+    const auto hop = (1 << order) / 8;
+
+    transform(levels[0], negativeInfinity);
+
+    for (int k = 1; k < numLevels; ++k)
+        if (levels[(size_t)k].samplesSinceTransform >= hop)
+            transform(levels[(size_t)k], negativeInfinity);
+
+    stitch();
+    fftDataFifo.publish();
+}
+
+void MultiResolutionAnalyzer::transform(Level& level, float negativeInfinity)
+{
+    const auto fftSize = 1 << order;
+    const auto numBins = fftSize / 2;
+
+    std::copy(level.samples.begin(), level.samples.end(), fftData.begin());
+
+    juce::FloatVectorOperations::multiply(fftData.data(), resources->window.data(), fftSize);
+    resources->fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    // normalised and converted the way FFTDataGenerator does it, then corrected for the level's bin width
+    const auto scale = level.gain / float(numBins);
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        auto v = fftData[(size_t)i];
+        v = std::isfinite(v) ? v * scale : 0.f;
+
+        level.spectrum[(size_t)i] = juce::Decibels::gainToDecibels(v, negativeInfinity);
+    }
+
+    level.samplesSinceTransform = 0;
+}
+
+void MultiResolutionAnalyzer::stitch()
+{
+    auto& stitched = fftDataFifo.getWriteSlot();
+
+    const auto numBins = (1 << order) / 2;
+
+    // bins [numBins / 4, numBins / 2) of a decimated level, [numBins / 4, numBins) of level 0,
+    // and everything below numBins / 2 of the last level
+    for (int k = 0; k < numLevels; ++k)
+    {
+        const auto& spectrum = levels[(size_t)k].spectrum;
+
+        const auto firstBin = k == numLevels - 1 ? 0 : numBins / 4;
+        const auto endBin = k == 0 ? numBins : numBins / 2;
+
+        // a bin of level k covers 2^(numDecimations - k) stitched bins
+        const auto shift = numDecimations - k;
+        auto* out = stitched.data() + ((size_t)firstBin << shift);
+
+        for (int bin = firstBin; bin < endBin; ++bin)
+        {
+            const auto value = spectrum[(size_t)bin];
+            out = std::fill_n(out, 1 << shift, value);
+        }
+    }
+}
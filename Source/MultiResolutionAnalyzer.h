@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    MultiResolutionAnalyzer.h
+
+    Resolves the low octaves as finely as a much longer FFT would, by running
+    the normal FFT size on half-band decimated copies of the signal and
+    stitching the octaves together.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FFTResourceCache.h"
+#include "PluginProcessor.h"
+
+#include <array>
+#include <vector>
+
+/*
+ 11 tap half-band lowpass and decimation by two. only the three odd taps and the
+ centre tap are non-zero, so an output sample costs four multiplies. the taps are
+ equiripple for a passband to fs / 8 and a stopband from 3 fs / 8 (about -56 dB
+ both ways): everything that folds into the bottom half of the new band is
+ rejected, which is the half MultiResolutionAnalyzer uses.
+ */
+struct HalfBandDecimator
+{
+    static constexpr int numTaps = 11;
+
+    void reset();
+
+    // writes (numSamples + 1) / 2 samples at most, returns how many
+    int process(const float* input, int numSamples, float* output);
+
+private:
+    static constexpr int historySize = numTaps - 1;
+    static constexpr int chunkSize = 256;
+
+    // the last historySize input samples, then the chunk being filtered
+    std::array<float, historySize + chunkSize> work{};
+
+    // whether the next output lands on the first sample of the next chunk (0) or the second (1)
+    int phase = 0;
+};
+
+/*
+ level 0 is the input, level k the input decimated by 2^k. every level runs the same
+ FFT size, so level k has 2^k times level 0's frequency resolution (and a window
+ 2^k times as long). each level only supplies the octave below half of its Nyquist,
+ where the decimators above it left it clean:
+
+   level 0                 fs / 8 ... fs / 2
+   level k, 0 < k < last   fs / 2^(k + 3) ... fs / 2^(k + 2)
+   last level              0 ... fs / 2^(last + 2)
+
+ the stitched spectrum has the bins an FFT of 2^numDecimations times the size would
+ give, with the upper octaves repeating their coarser bins, so it goes straight into
+ the analyzer's log-frequency map, the spectrogram and frame export.
+
+ what the levels' dB mean depends on the normalisation. every level is normalised
+ like FFTDataGenerator, so a sinusoid reads the same on all of them, as it would in
+ the long FFT (Tone). but a bin of level k is 2^k times narrower, so it holds 2^k
+ times less of a broadband signal's power, and noise would step down about 3 dB at
+ each stitch point. Noise adds 10 log10(2^k) dB to level k, which refers every level
+ to level 0's bin width: noise then reads flat and like the single FFT, and tones
+ below fs / 8 read 3 dB higher per octave down.
+
+ level 0 transforms for every pushed block, as FFTDataGenerator does. a decimated
+ level only transforms once an eighth of its window is new, so each one after the
+ first runs at most half as often as the one before, and all of them together cost
+ a few small FFTs per block instead of the large one.
+ */
+struct MultiResolutionAnalyzer
+{
+    static constexpr int numDecimations = 3;
+    static constexpr int numLevels = numDecimations + 1;
+
+    enum class Normalisation
+    {
+        Tone,
+        Noise
+    };
+
+    // the FFT order every level runs at
+    void prepare(int fftOrder);
+
+    void pushSamples(const float* samples, int numSamples, float negativeInfinity);
+
+    // kept across prepare(). every level is transformed again by the next pushSamples()
+    void setNormalisation(Normalisation newNormalisation);
+    Normalisation getNormalisation() const { return normalisation; }
+
+    // size of the FFT the stitched spectrum stands in for
+    int getFFTSize() const { return (1 << order) << numDecimations; }
+    int getFFTOrder() const { return order + numDecimations; }
+
+    // the oldest queued stitched spectrum, or nullptr. valid until a later call returns another one
+    const std::vector<float>* getFFTData() { return fftDataFifo.acquire(); }
+
+private:
+    int order = 0;
+    Normalisation normalisation = Normalisation::Tone;
+    FFTResourceCache::Handle resources;
+
+    struct Level
+    {
+        HalfBandDecimator decimator;        // from the level above, unused on level 0
+        std::vector<float> samples;         // the latest fftSize samples at this level's rate
+        std::vector<float> spectrum;        // dB, fftSize / 2 bins
+        float gain = 1.f;                   // on top of FFTDataGenerator's normalisation, see Normalisation
+        int samplesSinceTransform = 0;
+    };
+
+    std::array<Level, numLevels> levels;
+
+    std::vector<float> fftData;
+    std::vector<float> decimated[2];
+
+    void append(Level& level, const float* newSamples, int numSamples);
+    void transform(Level& level, float negativeInfinity);
+    void stitch();
+
+    // latest wins, like FFTDataGenerator's
+    Fifo<std::vector<float>, 30, FifoOverflow::OverwriteOldest> fftDataFifo;
+};
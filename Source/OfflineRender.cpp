@@ -0,0 +1,350 @@
+/*
+  ==============================================================================
+
+    OfflineRender.cpp
+
+  ==============================================================================
+*/
+
+#include "OfflineRender.h"
+
+#include <condition_variable>
+#include <thread>
+
+namespace
+{
+    void prepareBank(BiquadBank& bank, const ChainSettings& chainSettings, double sampleRate)
+    {
+        const auto bands = makePanelBands(chainSettings);
+
+        bank.prepare(sampleRate);
+        bank.setNumBands(numPanelBands);
+
+        for (int band = 0; band < numPanelBands; ++band)
+            bank.setBand(band, bands[(size_t)band]);
+    }
+
+    // radius of the section's slowest pole, the roots of z^2 + a1 z + a2
+    double getSlowestPoleRadius(const BiquadBank::Section& section)
+    {
+        const auto a1 = (double)section[3];
+        const auto a2 = (double)section[4];
+        const auto discriminant = a1 * a1 - 4.0 * a2;
+
+        if (discriminant < 0.0)
+            return std::sqrt(a2);
+
+        const auto root = std::sqrt(discriminant);
+        return juce::jmax(std::abs(0.5 * (-a1 + root)), std::abs(0.5 * (-a1 - root)));
+    }
+
+    double getMilliseconds(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    }
+}
+
+int OfflineRender::computeWarmUpSamples(const ChainSettings& chainSettings, double sampleRate, double decayDb)
+{
+    const auto plan = RoutingPlan::make(chainSettings);
+    const auto bands = makePanelBands(chainSettings);
+
+    juce::uint32 activeBands = 0;
+    for (int i = 0; i < plan.numSegments; ++i)
+        activeBands |= plan.segments[i].activeBands[0] | plan.segments[i].activeBands[1];
+
+    const auto logDecay = std::log(std::pow(10.0, decayDb / 20.0));
+    double samples = 0.0;
+
+    for (int band = 0; band < numPanelBands; ++band)
+    {
+        if ((activeBands & (1u << band)) == 0)
+            continue;
+
+        std::array<BiquadBank::Section, BiquadBank::maxSectionsPerBand> sections;
+        const auto numSections = BiquadBank::design(bands[(size_t)band], sampleRate, sections.data());
+
+        for (int s = 0; s < numSections; ++s)
+        {
+            const auto radius = getSlowestPoleRadius(sections[(size_t)s]);
+
+            // a pole on or outside the unit circle never forgets, the caller's maximum has to do
+            if (radius >= 1.0)
+                return std::numeric_limits<int>::max();
+
+            if (radius > 0.0)
+                samples += logDecay / std::log(radius);
+        }
+    }
+
+    return (int)std::ceil(samples);
+}
+
+//==============================================================================
+OfflineRender::Input::Input(juce::AudioFormatReader& readerToUse) : reader(readerToUse)
+{
+    jassert(reader.numChannels == 1 || reader.numChannels == 2);
+}
+
+void OfflineRender::Input::read(juce::AudioBuffer<float>& buffer, juce::int64 startInFile, int numSamples)
+{
+    jassert(buffer.getNumChannels() == RoutingPlan::numChannels && numSamples <= buffer.getNumSamples());
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    reader.read(&buffer, 0, numSamples, startInFile, true, true);
+
+    if (reader.numChannels == 1)
+        buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+}
+
+//==============================================================================
+namespace
+{
+    // the plain single pass, a chunk at a time
+    struct SerialStream
+    {
+        static constexpr int chunkLength = 1 << 16;
+
+        SerialStream(OfflineRender::Input& inputToUse, const ChainSettings& chainSettings) :
+            input(inputToUse),
+            plan(RoutingPlan::make(chainSettings)),
+            buffer(RoutingPlan::numChannels, chunkLength)
+        {
+            prepareBank(bank, chainSettings, input.getSampleRate());
+        }
+
+        // the next numSamples, up to chunkLength, at the start of getBuffer()
+        void renderNext(int numSamples)
+        {
+            jassert(numSamples <= chunkLength);
+            juce::ScopedNoDenormals noDenormals;
+
+            input.read(buffer, position, numSamples);
+
+            juce::dsp::AudioBlock<float> block(buffer);
+            plan.process(bank, block.getSubBlock(0, (size_t)numSamples));
+
+            position += numSamples;
+        }
+
+        int getNumSamplesLeft() const { return (int)juce::jmin((juce::int64)chunkLength, input.getNumSamples() - position); }
+        const juce::AudioBuffer<float>& getBuffer() const { return buffer; }
+
+    private:
+        OfflineRender::Input& input;
+        const RoutingPlan plan;
+        BiquadBank bank;
+        juce::AudioBuffer<float> buffer;
+        juce::int64 position = 0;
+    };
+}
+
+OfflineRender::Report OfflineRender::renderSerial(Input& input, const ChainSettings& chainSettings, const Sink& sink)
+{
+    Report report;
+    report.segmentLength = SerialStream::chunkLength;
+    report.bufferBytes = (size_t)(RoutingPlan::numChannels * SerialStream::chunkLength) * sizeof(float);
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    SerialStream stream(input, chainSettings);
+    report.completed = true;
+
+    for (auto length = stream.getNumSamplesLeft(); length > 0 && report.completed; length = stream.getNumSamplesLeft())
+    {
+        stream.renderNext(length);
+        report.completed = sink(stream.getBuffer(), 0, length);
+    }
+
+    report.milliseconds = getMilliseconds(startTicks);
+    return report;
+}
+
+OfflineRender::Report OfflineRender::render(Input& input, const ChainSettings& chainSettings, const Options& options, const Sink& sink)
+{
+    Report report;
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    const auto sampleRate = input.getSampleRate();
+    const auto numSamples = input.getNumSamples();
+
+    const auto plan = RoutingPlan::make(chainSettings);
+
+    report.warmUpSamples = juce::jmin(computeWarmUpSamples(chainSettings, sampleRate, options.warmUpDecayDb),
+                                      juce::roundToInt(options.maxWarmUpSeconds * sampleRate));
+
+    const auto numCores = options.numThreads > 0 ? options.numThreads : juce::SystemStats::getNumCpus();
+    report.numThreads = juce::jmax(1, numCores);
+
+    // a segment much shorter than its warm-up would spend most of its time warming up
+    report.segmentLength = juce::jmax(options.segmentLength, 4 * report.warmUpSamples, 1 << 15);
+    report.numSegments = (int)juce::jmax((juce::int64)1, (numSamples + report.segmentLength - 1) / report.segmentLength);
+    report.numThreads = juce::jmin(report.numThreads, report.numSegments);
+
+    /*
+     segment k is read and rendered into slot k % slots.size(), with the warm-up in front of it.
+     the slot is free again once segment k - slots.size() has been through the sink
+     */
+    struct Slot
+    {
+        juce::AudioBuffer<float> buffer;
+        int segment = -1, start = 0, numSamples = 0;
+    };
+
+    const auto numSlots = juce::jlimit(1, report.numSegments, report.numThreads * juce::jmax(1, options.segmentsInFlightPerThread));
+    std::vector<Slot> slots((size_t)numSlots);
+
+    for (auto& slot : slots)
+        slot.buffer.setSize(RoutingPlan::numChannels, report.warmUpSamples + report.segmentLength);
+
+    report.bufferBytes = (size_t)numSlots * (size_t)(RoutingPlan::numChannels * (report.warmUpSamples + report.segmentLength)) * sizeof(float);
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    int nextSegment = 0, numWritten = 0;
+    bool stopped = false;
+
+    auto renderSegments = [&]
+    {
+        juce::ScopedNoDenormals noDenormals;
+        BiquadBank bank;
+
+        for (;;)
+        {
+            int segment = 0;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return stopped || nextSegment >= report.numSegments || nextSegment < numWritten + numSlots; });
+
+                if (stopped || nextSegment >= report.numSegments)
+                    return;
+
+                segment = nextSegment++;
+            }
+
+            auto& slot = slots[(size_t)(segment % numSlots)];
+
+            const auto start = (juce::int64)segment * report.segmentLength;
+            const auto length = (int)juce::jmin((juce::int64)report.segmentLength, numSamples - start);
+            const auto warmUp = (int)juce::jmin((juce::int64)report.warmUpSamples, start);
+
+            input.read(slot.buffer, start - warmUp, warmUp + length);
+
+            prepareBank(bank, chainSettings, sampleRate);
+
+            juce::dsp::AudioBlock<float> block(slot.buffer);
+            plan.process(bank, block.getSubBlock(0, (size_t)(warmUp + length)));
+
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                slot.segment = segment;
+                slot.start = warmUp;
+                slot.numSamples = length;
+            }
+
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < report.numThreads; ++i)
+        threads.emplace_back(renderSegments);
+
+    // this thread hands the segments to the sink in order, each as soon as it's rendered
+    for (int segment = 0; segment < report.numSegments; ++segment)
+    {
+        auto& slot = slots[(size_t)(segment % numSlots)];
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return slot.segment == segment; });
+        }
+
+        // no worker touches the slot until numWritten moves past it
+        const auto accepted = sink(slot.buffer, slot.start, slot.numSamples);
+
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            numWritten += 1;
+            stopped = !accepted;
+        }
+
+        changed.notify_all();
+
+        if (!accepted)
+            break;
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        report.completed = numWritten == report.numSegments && !stopped;
+        stopped = true;
+    }
+
+    changed.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    report.milliseconds = getMilliseconds(startTicks);
+    return report;
+}
+
+std::vector<OfflineRender::ScalingResult> OfflineRender::measureScaling(Input& input, const ChainSettings& chainSettings, int maxThreads)
+{
+    std::vector<ScalingResult> results;
+
+    const Sink discard = [](const juce::AudioBuffer<float>&, int, int) { return true; };
+    const auto serialMs = renderSerial(input, chainSettings, discard).milliseconds;
+
+    for (int numThreads = 1; numThreads <= maxThreads; ++numThreads)
+    {
+        Options options;
+        options.numThreads = numThreads;
+
+        ScalingResult result;
+        result.numThreads = numThreads;
+        result.milliseconds = render(input, chainSettings, options, discard).milliseconds;
+        result.speedUp = serialMs / juce::jmax(1.0e-6, result.milliseconds);
+
+        // the serial render follows the segmented one chunk by chunk, on the sink's thread
+        SerialStream reference(input, chainSettings);
+        int referenceStart = 0, referenceLength = 0;
+
+        const Sink compare = [&](const juce::AudioBuffer<float>& buffer, int start, int numSamples)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                if (referenceStart == referenceLength)
+                {
+                    referenceLength = reference.getNumSamplesLeft();
+                    referenceStart = 0;
+
+                    if (referenceLength == 0)
+                        return false;
+
+                    reference.renderNext(referenceLength);
+                }
+
+                for (int ch = 0; ch < RoutingPlan::numChannels; ++ch)
+                {
+                    const auto error = std::abs((double)buffer.getSample(ch, start + i) - (double)reference.getBuffer().getSample(ch, referenceStart));
+                    result.maxAbsError = juce::jmax(result.maxAbsError, error);
+                }
+
+                ++referenceStart;
+            }
+
+            return true;
+        };
+
+        if (!render(input, chainSettings, options, compare).completed)
+            result.maxAbsError = std::numeric_limits<double>::infinity();
+
+        results.push_back(result);
+    }
+
+    return results;
+}
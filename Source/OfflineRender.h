@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    OfflineRender.h
+
+    Renders one long stereo file through the panel's bands on several
+    threads at once, for bouncing and batch processing outside a host.
+    Segments stream from the reader to the writer, so memory doesn't
+    grow with the file. The console tool runs it with
+    "render <input> <output>".
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterEngine.h"
+
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/*
+ IIR state carries through the whole file, so it can't just be cut into pieces, but it
+ also forgets: with no more input, every section's output dies away as its slowest pole,
+ r^n. the warm-up is the number of samples the whole cascade (summed per section, which
+ errs long) needs to decay by warmUpDecayDb.
+
+ every segment is run from silence over the warm-up samples of input just before it,
+ then over itself, so what is missing from its history is below warmUpDecayDb. what's
+ left against a serial render is float rounding: two float cascades that start from
+ different states settle a few ulps of their state apart, and stay there. that is
+ the tolerance measureScaling() reports.
+
+ segments are read, rendered on the worker threads and handed to the sink in file order
+ from the calling thread. only segmentsInFlightPerThread segments per thread are held at
+ a time: a worker that gets too far ahead of the sink waits for it.
+
+ the bands are rendered static: dynamic peaks stay at their set gain, and auto gain
+ isn't applied, since neither forgets on a scale a warm-up could cover.
+ */
+struct OfflineRender
+{
+    /*
+     a mono or stereo file read as stereo, mono as dual mono. AudioFormatReader isn't
+     thread-safe, so reads from any thread take turns
+     */
+    struct Input
+    {
+        explicit Input(juce::AudioFormatReader& reader);
+
+        // numSamples from startInFile into the start of buffer, which has room for them
+        void read(juce::AudioBuffer<float>& buffer, juce::int64 startInFile, int numSamples);
+
+        double getSampleRate() const { return reader.sampleRate; }
+        juce::int64 getNumSamples() const { return reader.lengthInSamples; }
+
+    private:
+        juce::AudioFormatReader& reader;
+        std::mutex mutex;
+    };
+
+    // gets the rendered audio in file order, numSamples from start in buffer at a time. false stops the render
+    using Sink = std::function<bool(const juce::AudioBuffer<float>& buffer, int start, int numSamples)>;
+
+    struct Options
+    {
+        int numThreads = 0;                 // 0 = one per core
+        int segmentLength = 1 << 18;        // at least four warm-ups
+        int segmentsInFlightPerThread = 2;  // so a worker can render the next segment while the sink writes one
+        double warmUpDecayDb = -120.0;
+        double maxWarmUpSeconds = 30.0;
+    };
+
+    struct Report
+    {
+        bool completed = false;             // every segment reached the sink
+        int numThreads = 1;
+        int numSegments = 1;
+        int segmentLength = 0;
+        int warmUpSamples = 0;
+        size_t bufferBytes = 0;             // held for segments in flight, whatever the file's length
+        double milliseconds = 0.0;
+    };
+
+    static Report render(Input& input, const ChainSettings& chainSettings, const Options& options, const Sink& sink);
+
+    // the plain single pass, which render() is checked against
+    static Report renderSerial(Input& input, const ChainSettings& chainSettings, const Sink& sink);
+
+    // samples for every active band of chainSettings, in series, to decay by decayDb
+    static int computeWarmUpSamples(const ChainSettings& chainSettings, double sampleRate, double decayDb);
+
+    struct ScalingResult
+    {
+        int numThreads = 1;
+        double milliseconds = 0.0;
+        double speedUp = 1.0;           // against renderSerial()
+        double maxAbsError = 0.0;       // against renderSerial()
+    };
+
+    /*
+     times renderSerial(), then render() with 1 to maxThreads threads, all into a sink that
+     discards the audio. each thread count is rendered once more, untimed, against a serial
+     render running alongside it, for the error. nothing is held beyond the segments in flight
+     */
+    static std::vector<ScalingResult> measureScaling(Input& input, const ChainSettings& chainSettings, int maxThreads);
+};
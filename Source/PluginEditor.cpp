@@ -125,7 +125,7 @@ void LookAndFeel::drawToggleButton(juce::Graphics& g,
         auto bounds = toggleButton.getLocalBounds();
         g.drawRect(bounds);
 
-        g.strokePath(analyzerButton->randomPath, PathStrokeType(1.f));
+        g.strokePath(analyzerButton->getRandomPath(), PathStrokeType(1.f));
     }
 }
 
@@ -134,8 +134,8 @@ void RotarySliderWithLabels::paint(juce::Graphics& g)
 {
     using namespace juce;
 
-    auto startAng = degreesToRadians(180.f + 45.f);
-    auto endAng = degreesToRadians(180.f - 45.f) + MathConstants<float>::twoPi;
+    auto startAng = getStartAngle();
+    auto endAng = getEndAngle();
 
     auto range = getRange();
 
@@ -159,6 +159,41 @@ void RotarySliderWithLabels::paint(juce::Graphics& g)
                                       endAng, 
                                       *this);
 
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (labelLayer.isNull() || scale != labelLayerScale)
+        rebuildLabelLayer(scale);
+
+    if (labelLayer.isValid())
+        g.drawImage(labelLayer, getLocalBounds().toFloat());
+}
+
+void RotarySliderWithLabels::resized()
+{
+    juce::Slider::resized();
+
+    labelLayer = {};
+}
+
+void RotarySliderWithLabels::rebuildLabelLayer(float scale)
+{
+    using namespace juce;
+
+    labelLayerScale = scale;
+    labelLayer = {};
+
+    if (getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    labelLayer = Image(Image::ARGB, roundToInt(getWidth() * scale), roundToInt(getHeight() * scale), true);
+
+    Graphics g(labelLayer);
+    g.addTransform(AffineTransform::scale(scale));
+
+    auto startAng = getStartAngle();
+    auto endAng = getEndAngle();
+
+    auto sliderBounds = getSliderBounds();
     auto center = sliderBounds.toFloat().getCentre();
     auto radius = sliderBounds.getWidth() * 0.5f;
 
@@ -240,97 +275,231 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 }
 
 //==============================================================================
-ResponseCurveComponent::ResponseCurveComponent(SpectrumEQAudioProcessor& p) :
-    audioProcessor(p),
-    leftPathProducer(audioProcessor.leftChannelFifo),
-    rightPathProducer(audioProcessor.rightChannelFifo)
+void BandResponseCache::prepare(int numPoints, double newSampleRate)
 {
-    const auto& params = audioProcessor.getParameters();
-    for (auto param : params)
+    using namespace juce;
+
+    numPoints = jmax(1, numPoints);
+    sampleRate = newSampleRate;
+
+    cosW.resize(numPoints);
+    sinW.resize(numPoints);
+    cos2W.resize(numPoints);
+    sin2W.resize(numPoints);
+
+    for (int i = 0; i < numPoints; ++i)
     {
-        param->addListener(this);
+        auto freq = mapToLog10(double(i) / double(numPoints), 20.0, 20000.0);
+        auto w = sampleRate > 0.0 ? MathConstants<double>::twoPi * freq / sampleRate : 0.0;
+
+        cosW[i] = std::cos(w);
+        sinW[i] = std::sin(w);
+        cos2W[i] = std::cos(2.0 * w);
+        sin2W[i] = std::sin(2.0 * w);
     }
 
-    updateChain();
+    power.assign(numPoints, 1.0);
 
-    startTimerHz(60);
-}
+    for (auto& band : bandDecibels)
+        band.assign(numPoints, 0.0);
 
-ResponseCurveComponent::~ResponseCurveComponent()
-{
-    const auto& params = audioProcessor.getParameters();
-    for (auto param : params)
+    totalDecibels.assign(numPoints, 0.0);
+
+    for (int band = 0; band < numBands; ++band)
     {
-        param->removeListener(this);
+        bandPhase[band].assign(numPoints, 0.0);
+        bandGroupDelay[band].assign(numPoints, 0.0);
     }
+
+    totalPhase.assign(numPoints, 0.0);
+    totalGroupDelay.assign(numPoints, 0.0);
 }
 
-void ResponseCurveComponent::updateResponseCurve()
+void BandResponseCache::setBandSections(int band, const BiquadBank::Section* sections, int numSections)
 {
-    using namespace juce;
+    jassert(juce::isPositiveAndBelow(band, numBands));
 
-    auto responseArea = getAnalysisArea(); // getRenderArea();
-    auto w = responseArea.getWidth();
+    const auto numPoints = getNumPoints();
+    auto* p = power.data();
+    const auto* c1 = cosW.data();
+    const auto* s1 = sinW.data();
+    const auto* c2 = cos2W.data();
+    const auto* s2 = sin2W.data();
 
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& lowPeak = monoChain.get<ChainPositions::LowPeak>();
-    auto& lowMidPeak = monoChain.get<ChainPositions::LowMidPeak>();
-    auto& highMidPeak = monoChain.get<ChainPositions::HighMidPeak>();
-    auto& highPeak = monoChain.get<ChainPositions::HighPeak>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
+    std::fill(power.begin(), power.end(), 1.0);
 
-    auto sampleRate = audioProcessor.getSampleRate();
+    for (int s = 0; s < numSections; ++s)
+    {
+        // normalised by a0, as BiquadBank runs them: { b0, b1, b2, a1, a2 }
+        const double b0 = sections[s][0];
+        const double b1 = sections[s][1];
+        const double b2 = sections[s][2];
+        const double a1 = sections[s][3];
+        const double a2 = sections[s][4];
+
+        // |H(e^jw)|^2, written as straight loops over the tables so the compiler can vectorise them
+        for (int i = 0; i < numPoints; ++i)
+        {
+            auto numRe = b0 + b1 * c1[i] + b2 * c2[i];
+            auto numIm = b1 * s1[i] + b2 * s2[i];
+            auto denRe = 1.0 + a1 * c1[i] + a2 * c2[i];
+            auto denIm = a1 * s1[i] + a2 * s2[i];
+
+            p[i] *= (numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm);
+        }
+    }
 
-    std::vector<double> mags;
+    auto* dB = bandDecibels[band].data();
 
-    mags.resize(w);
+    for (int i = 0; i < numPoints; ++i)
+        dB[i] = 10.0 * std::log10(juce::jmax(p[i], 1.0e-10)); // floor at -100 dB, like Decibels::gainToDecibels
 
-    for (int i = 0; i < w; ++i)
-    {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
+    if (!computePhase)
+        return;
 
-        if (!monoChain.isBypassed<ChainPositions::LowPeak>())
-            mag *= lowPeak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    auto* phase = bandPhase[band].data();
+    auto* delay = bandGroupDelay[band].data();
 
-        if (!monoChain.isBypassed<ChainPositions::LowMidPeak>())
-            mag *= lowMidPeak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    std::fill(bandPhase[band].begin(), bandPhase[band].end(), 0.0);
+    std::fill(bandGroupDelay[band].begin(), bandGroupDelay[band].end(), 0.0);
 
-        if (!monoChain.isBypassed<ChainPositions::HighMidPeak>())
-            mag *= highMidPeak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    /*
+     for P(w) = p0 + p1 e^{-jw} + p2 e^{-2jw}, the group delay -d(arg P)/dw is
+     Re{ (p1 e^{-jw} + 2 p2 e^{-2jw}) / P(w) }, and a section's is numerator's minus denominator's.
+     below, 'im' is the negated imaginary part, as in the magnitude loop above
+     */
+    auto polynomialDelay = [](double re, double im, double dRe, double dIm)
+    {
+        const auto magnitudeSquared = re * re + im * im;
+        return magnitudeSquared > 1.0e-30 ? (dRe * re + dIm * im) / magnitudeSquared : 0.0;
+    };
 
-        if (!monoChain.isBypassed<ChainPositions::HighPeak>())
-            mag *= highPeak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+    for (int s = 0; s < numSections; ++s)
+    {
+        const double b0 = sections[s][0];
+        const double b1 = sections[s][1];
+        const double b2 = sections[s][2];
+        const double a1 = sections[s][3];
+        const double a2 = sections[s][4];
 
-        if (!monoChain.isBypassed<ChainPositions::LowCut>())
+        for (int i = 0; i < numPoints; ++i)
         {
-            if (!lowcut.isBypassed<0>())
-                mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!lowcut.isBypassed<1>())
-                mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!lowcut.isBypassed<2>())
-                mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!lowcut.isBypassed<3>())
-                mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+            auto numRe = b0 + b1 * c1[i] + b2 * c2[i];
+            auto numIm = b1 * s1[i] + b2 * s2[i];
+            auto denRe = 1.0 + a1 * c1[i] + a2 * c2[i];
+            auto denIm = a1 * s1[i] + a2 * s2[i];
+
+            phase[i] += std::atan2(-numIm, numRe) - std::atan2(-denIm, denRe);
+
+            delay[i] += polynomialDelay(numRe, numIm, b1 * c1[i] + 2.0 * b2 * c2[i], b1 * s1[i] + 2.0 * b2 * s2[i])
+                      - polynomialDelay(denRe, denIm, a1 * c1[i] + 2.0 * a2 * c2[i], a1 * s1[i] + 2.0 * a2 * s2[i]);
         }
+    }
+}
+
+void BandResponseCache::sumBands()
+{
+    std::fill(totalDecibels.begin(), totalDecibels.end(), 0.0);
+
+    const auto numPoints = getNumPoints();
+    auto* total = totalDecibels.data();
+
+    for (const auto& band : bandDecibels)
+    {
+        const auto* dB = band.data();
+
+        for (int i = 0; i < numPoints; ++i)
+            total[i] += dB[i];
+    }
+
+    if (!computePhase)
+        return;
+
+    std::fill(totalPhase.begin(), totalPhase.end(), 0.0);
+    std::fill(totalGroupDelay.begin(), totalGroupDelay.end(), 0.0);
 
-        if (!monoChain.isBypassed<ChainPositions::HighCut>())
+    for (int band = 0; band < numBands; ++band)
+    {
+        for (int i = 0; i < numPoints; ++i)
         {
-            if (!highcut.isBypassed<0>())
-                mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!highcut.isBypassed<1>())
-                mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!highcut.isBypassed<2>())
-                mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-            if (!highcut.isBypassed<3>())
-                mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+            totalPhase[i] += bandPhase[band][i];
+            totalGroupDelay[i] += bandGroupDelay[band][i];
         }
+    }
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        totalPhase[i] = std::remainder(totalPhase[i], juce::MathConstants<double>::twoPi);
+        totalGroupDelay[i] /= sampleRate;
+    }
+}
+
+//==============================================================================
+ResponseCurveComponent::ResponseCurveComponent(SpectrumEQAudioProcessor& p) :
+    audioProcessor(p),
+    leftPathProducer(audioProcessor.leftChannelFifo),
+    rightPathProducer(audioProcessor.rightChannelFifo)
+{
+    // paint() covers every pixel, so the editor behind us never needs repainting
+    setOpaque(true);
+}
+
+ResponseCurveComponent::~ResponseCurveComponent()
+{
+    if (!listeningToParameters)
+        return;
+
+    const auto& params = audioProcessor.getParameters();
+    for (auto param : params)
+    {
+        param->removeListener(this);
+    }
+}
 
-        mags[i] = Decibels::gainToDecibels(mag);
+void ResponseCurveComponent::startListeningToParameters()
+{
+    const auto& params = audioProcessor.getParameters();
+
+    bandMaskForParameter.resize(params.size(), 0);
+
+    for (auto param : params)
+    {
+        auto index = param->getParameterIndex();
+
+        if (juce::isPositiveAndBelow(index, (int)NumParameters) && parameterTable[index].band != noBand)
+            bandMaskForParameter[index] = 1u << parameterTable[index].band;
     }
 
+    for (auto param : params)
+        param->addListener(this);
+
+    listeningToParameters = true;
+
+    // anything that changed before we were listening. resized() designed the rest, they needn't be designed again
+    dirtyBands.fetch_or(getOutdatedBands());
+}
+
+void ResponseCurveComponent::updateBandResponse(int band)
+{
+    responseCache.setBandSections(band, bandSections[(size_t)band].data(), numBandSections[(size_t)band]);
+}
+
+void ResponseCurveComponent::updateResponseCurve()
+{
+    SPECTRUMEQ_TRACE_SCOPE("ResponseCurveComponent::updateResponseCurve");
+
+    using namespace juce;
+
+    auto responseArea = getAnalysisArea(); // getRenderArea();
+
+    responseCache.sumBands();
+    const auto& mags = responseCache.getTotalDecibels();
+
     responseCurve.clear();
 
+    if (mags.empty())
+        return;
+
     const double outputMin = responseArea.getBottom();
     const double outputMax = responseArea.getY();
 
@@ -345,34 +514,294 @@ void ResponseCurveComponent::updateResponseCurve()
     {
         responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
     }
+
+    buildOverlayCurves(responseArea);
+}
+
+void ResponseCurveComponent::setOverlays(bool showPhase, bool showGroupDelay)
+{
+    shouldShowPhase = showPhase;
+    shouldShowGroupDelay = showGroupDelay;
+
+    const auto computePhase = showPhase || showGroupDelay;
+
+    // bands evaluated while the overlays were off have no phase yet, and a newly shown curve was never built
+    overlaysStale = computePhase;
+
+    responseCache.setComputesPhase(computePhase);
+    needsRepaint = true;
+}
+
+void ResponseCurveComponent::buildOverlayCurves(juce::Rectangle<int> responseArea)
+{
+    using namespace juce;
+
+    phaseCurve.clear();
+    groupDelayCurve.clear();
+
+    if (!responseCache.computesPhase())
+        return;
+
+    const auto bottom = (double)responseArea.getBottom();
+    const auto top = (double)responseArea.getY();
+    const auto left = (double)responseArea.getX();
+
+    if (shouldShowPhase)
+    {
+        const auto& phase = responseCache.getTotalPhase();
+
+        for (size_t i = 0; i < phase.size(); ++i)
+        {
+            const auto y = (float)jmap(phase[i], -MathConstants<double>::pi, MathConstants<double>::pi, bottom, top);
+
+            // a wrap from +180 to -180 degrees isn't a line across the display
+            if (i == 0 || std::abs(phase[i] - phase[i - 1]) > MathConstants<double>::pi)
+                phaseCurve.startNewSubPath((float)(left + i), y);
+            else
+                phaseCurve.lineTo((float)(left + i), y);
+        }
+    }
+
+    if (shouldShowGroupDelay)
+    {
+        const auto& delay = responseCache.getTotalGroupDelay();
+
+        // the scale snaps to 1, 2, 5 x 10^n ms above the largest delay, so it doesn't breathe with every drag
+        const auto maxMs = 1000.0 * *std::max_element(delay.begin(), delay.end());
+        const auto decade = std::pow(10.0, std::floor(std::log10(jlimit(1.0, 1000.0, maxMs))));
+
+        for (auto multiple : { 1.0, 2.0, 5.0, 10.0 })
+        {
+            groupDelayScaleMs = multiple * decade;
+
+            if (groupDelayScaleMs >= maxMs)
+                break;
+        }
+
+        for (size_t i = 0; i < delay.size(); ++i)
+        {
+            const auto y = (float)jlimit(top, bottom, jmap(1000.0 * delay[i], 0.0, groupDelayScaleMs, bottom, top));
+
+            if (i == 0)
+                groupDelayCurve.startNewSubPath((float)left, y);
+            else
+                groupDelayCurve.lineTo((float)(left + i), y);
+        }
+    }
 }
 
 void ResponseCurveComponent::paint(juce::Graphics& g)
 {
+    SPECTRUMEQ_TRACE_SCOPE("ResponseCurveComponent::paint");
+
     using namespace juce;
 
-    g.fillAll(Colours::black);
+   #if SPECTRUMEQ_DEBUG_STATS
+    const auto paintStart = Time::getHighResolutionTicks();
+   #endif
+
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (backgroundLayer.isNull() || scale != layerScale)
+        rebuildLayers(scale);
+
+    if (backgroundLayer.isValid() && !drawLayersDirectly)
+    {
+        g.drawImage(backgroundLayer, getLocalBounds().toFloat());
+    }
+    else
+    {
+        g.fillAll(Colours::black);
 
-    drawBackgroundGrid(g);
+        if (drawLayersDirectly)
+            drawBackgroundGrid(g);
+    }
 
     auto responseArea = getAnalysisArea();
 
-    if (shouldShowFFTAnalysis)
+    if (shouldShowFFTAnalysis && rasteriseAnalyzer)
     {
-        auto leftChannelFFTPath = leftPathProducer.getPath();
-        leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        SpectrumRasteriser::Style leftStyle, rightStyle;
+        leftStyle.lineColour = Colour(97u, 18u, 167u);
+        rightStyle.lineColour = Colour(215u, 201u, 134u);
+
+        for (auto* style : { &leftStyle, &rightStyle })
+        {
+            style->fill = fillAnalyzer;
+            style->fillTop = style->lineColour.withAlpha(0.35f);
+            style->fillBottom = style->lineColour.withAlpha(0.f);
+        }
+
+        // at the physical pixel scale, so the image lands 1:1 on the screen
+        analyzerRasteriser.prepare(responseArea.getWidth(), responseArea.getHeight(), scale);
+        analyzerRasteriser.clear();
+        analyzerRasteriser.draw(leftPathProducer.getRenderData(), leftStyle);
+        analyzerRasteriser.draw(rightPathProducer.getRenderData(), rightStyle);
+
+        g.drawImage(analyzerRasteriser.getImage(), responseArea.toFloat());
+    }
+    else if (shouldShowFFTAnalysis)
+    {
+        buildAnalyzerPath(leftAnalyzerPath, leftPathProducer.getRenderData(), responseArea);
         g.setColour(Colour(97u, 18u, 167u));
-        g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
+        g.strokePath(leftAnalyzerPath, PathStrokeType(1.f));
 
-        auto rightChannelFFTPath = rightPathProducer.getPath();
-        rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
+        buildAnalyzerPath(rightAnalyzerPath, rightPathProducer.getRenderData(), responseArea);
         g.setColour(Colour(215u, 201u, 134u));
-        g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+        g.strokePath(rightAnalyzerPath, PathStrokeType(1.f));
     }
 
     g.setColour(Colours::white);
     g.strokePath(responseCurve, PathStrokeType(2.f));
 
+    if (shouldShowPhase || shouldShowGroupDelay)
+    {
+        auto legendArea = responseArea.reduced(4).removeFromTop(12);
+        g.setFont(10);
+
+        if (shouldShowPhase)
+        {
+            g.setColour(Colours::deepskyblue);
+            g.strokePath(phaseCurve, PathStrokeType(1.f));
+            g.drawText("phase +-180 deg", legendArea.removeFromRight(90), Justification::centredRight, false);
+        }
+
+        if (shouldShowGroupDelay)
+        {
+            g.setColour(Colours::lightgreen);
+            g.strokePath(groupDelayCurve, PathStrokeType(1.f));
+            g.drawText("delay 0-" + String(groupDelayScaleMs) + " ms", legendArea.removeFromRight(90), Justification::centredRight, false);
+        }
+    }
+
+    if (drawLayersDirectly)
+    {
+        drawBorder(g);
+        drawTextLabels(g);
+
+        g.setColour(Colours::orange);
+        g.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
+    }
+    else if (foregroundLayer.isValid())
+    {
+        g.drawImage(foregroundLayer, getLocalBounds().toFloat());
+    }
+
+   #if SPECTRUMEQ_DEBUG_STATS
+    paintTiming.addSample(paintStart);
+
+    if (paintTiming.getNumFrames() == 300)
+    {
+        Logger::writeToLog("ResponseCurveComponent::paint avg " + String(paintTiming.getAverageMs(), 3)
+                           + " ms, max " + String(paintTiming.getMaxMs(), 3) + " ms");
+        paintTiming.reset();
+    }
+   #endif
+}
+
+ResponseCurveComponent::PaintMeasurement ResponseCurveComponent::measurePaint(int numFrames, float scale)
+{
+    using namespace juce;
+
+    PaintMeasurement measurement;
+    measurement.numFrames = numFrames;
+    measurement.scale = scale;
+
+    if (getWidth() <= 0 || getHeight() <= 0 || numFrames <= 0)
+        return measurement;
+
+    Image target(Image::RGB, roundToInt(getWidth() * scale), roundToInt(getHeight() * scale), true, SoftwareImageType());
+
+    auto averageMs = [&](bool cached)
+    {
+        drawLayersDirectly = !cached;
+        PaintTimingStats stats;
+
+        for (int frame = -1; frame < numFrames; ++frame)
+        {
+            const auto start = Time::getHighResolutionTicks();
+
+            Graphics g(target);
+            g.addTransform(AffineTransform::scale(scale));
+
+            if (cached)
+                g.reduceClipRegion(getAnalysisArea());
+
+            paint(g);
+
+            if (frame >= 0)
+                stats.addSample(start);
+        }
+
+        return stats.getAverageMs();
+    };
+
+    measurement.uncachedMs = averageMs(false);
+    measurement.cachedMs = averageMs(true);
+
+    drawLayersDirectly = false;
+
+    // the layers are at the measured scale now, the next real paint puts them back
+    layerScale = 0.f;
+    return measurement;
+}
+
+void ResponseCurveComponent::buildAnalyzerPath(juce::Path& p, const std::vector<float>& ys, juce::Rectangle<int> area)
+{
+    p.clear();
+
+    if (ys.empty())
+        return;
+
+    const auto left = (float)area.getX();
+    const auto top = (float)area.getY();
+
+    p.startNewSubPath(left, top + ys[0]);
+
+    for (size_t x = 1; x < ys.size(); ++x)
+        p.lineTo(left + (float)x, top + ys[x]);
+}
+
+void ResponseCurveComponent::rebuildLayers(float scale)
+{
+    using namespace juce;
+
+    layerScale = scale;
+    backgroundLayer = {};
+    foregroundLayer = {};
+
+    if (getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    auto w = roundToInt(getWidth() * scale);
+    auto h = roundToInt(getHeight() * scale);
+
+    backgroundLayer = Image(Image::RGB, w, h, true);
+    {
+        Graphics bg(backgroundLayer);
+        bg.addTransform(AffineTransform::scale(scale));
+
+        bg.fillAll(Colours::black);
+        drawBackgroundGrid(bg);
+    }
+
+    foregroundLayer = Image(Image::ARGB, w, h, true);
+    {
+        Graphics fg(foregroundLayer);
+        fg.addTransform(AffineTransform::scale(scale));
+
+        drawBorder(fg);
+        drawTextLabels(fg);
+
+        fg.setColour(Colours::orange);
+        fg.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
+    }
+}
+
+void ResponseCurveComponent::drawBorder(juce::Graphics& g)
+{
+    using namespace juce;
+
     Path border;
     
     border.setUsingNonZeroWinding(false);
@@ -381,11 +810,6 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
 
     g.setColour(Colours::black);
     g.fillPath(border);
-
-    drawTextLabels(g);
-
-    g.setColour(Colours::orange);
-    g.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
 }
 
 std::vector<float> ResponseCurveComponent::getFrequencies()
@@ -531,73 +955,157 @@ void ResponseCurveComponent::resized()
     using namespace juce; 
 
     responseCurve.preallocateSpace(getWidth() * 3);
+
+    backgroundLayer = {};
+    foregroundLayer = {};
+
+    responseCache.prepare(getAnalysisArea().getWidth(), audioProcessor.getSampleRate());
+
+    // the first resize is where the bands get designed, the constructor leaves every band dirty
+    updateBandSections(dirtyBands.exchange(0));
+
+    for (int band = 0; band < BandResponseCache::numBands; ++band)
+        updateBandResponse(band);
+
     updateResponseCurve();
 }
 
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue)
 {
-    parametersChanged.set(true);
+    if (juce::isPositiveAndBelow(parameterIndex, (int)bandMaskForParameter.size()))
+        dirtyBands.fetch_or(bandMaskForParameter[parameterIndex]);
 }
 
-void ResponseCurveComponent::timerCallback()
+void ResponseCurveComponent::onVBlank()
 {
-    if (shouldShowFFTAnalysis)
+    // the attachment only fires while we are on a peer, but a minimised or hidden window still gets vblanks
+    if (!isShowing())
+        return;
+
+    if (auto* peer = getPeer(); peer != nullptr && peer->isMinimised())
+        return;
+
+    if (!listeningToParameters)
+        startListeningToParameters();
+
+    const bool analyzerPending = (shouldShowFFTAnalysis || isFeedingSpectrogram())
+        && (leftPathProducer.hasNewAudio() || rightPathProducer.hasNewAudio());
+
+    const bool curvePending = needsRepaint
+        || dirtyBands.load() != 0
+        || audioProcessor.getSampleRate() != responseCache.getSampleRate();
+
+    if (!analyzerPending && !curvePending)
+        return;
+
+    const auto rateHz = (curvePending || !analyzerIsIdle) ? maxRefreshRateHz : idleRefreshRateHz;
+    const auto now = juce::Time::getMillisecondCounterHiRes();
+
+    if (now - lastRefreshMs < 1000.0 / rateHz)
+        return;
+
+    lastRefreshMs = now;
+    refresh();
+}
+
+void ResponseCurveComponent::refresh()
+{
+    auto sampleRate = audioProcessor.getSampleRate();
+
+    const auto feedSpectrogram = isFeedingSpectrogram();
+
+    if (shouldShowFFTAnalysis || feedSpectrogram)
     {
         auto fftBounds = getAnalysisArea().toFloat();
-        auto sampleRate = audioProcessor.getSampleRate();
 
-        leftPathProducer.process(fftBounds, sampleRate);
-        rightPathProducer.process(fftBounds, sampleRate);
+        leftPathProducer.process(fftBounds, sampleRate, shouldShowFFTAnalysis);
+        rightPathProducer.process(fftBounds, sampleRate, shouldShowFFTAnalysis);
+
+        analyzerIsIdle = leftPathProducer.isSilent() && rightPathProducer.isSilent();
+
+        if (feedSpectrogram)
+        {
+            // one column per analyzer frame, so the time axis doesn't depend on the refresh rate.
+            // the channels are drained a moment apart, so one may be a frame ahead: its partner repeats its newest
+            const auto fftSize = leftPathProducer.getFFTSize();
+            const auto numFrames = jmax(leftPathProducer.getNumNewSpectra(), rightPathProducer.getNumNewSpectra());
+
+            for (int i = 0; i < numFrames; ++i)
+                spectrogram->pushSpectra(leftPathProducer.getNewSpectrum(i),
+                                         rightPathProducer.getNewSpectrum(i),
+                                         fftSize,
+                                         float(sampleRate / double(fftSize)),
+                                         -48.f);
+        }
+    }
+
+    if (sampleRate != responseCache.getSampleRate())
+    {
+        // the grid's e^{-jw} tables depend on the sample rate, every band has to be redone
+        responseCache.prepare(getAnalysisArea().getWidth(), sampleRate);
+        dirtyBands.fetch_or(BandResponseCache::allBands);
     }
 
-    if (parametersChanged.compareAndSetBool(false, true))
+    const auto bands = dirtyBands.exchange(0);
+    const auto bandsToEvaluate = overlaysStale ? BandResponseCache::allBands : bands;
+
+    overlaysStale = false;
+
+    if (bandsToEvaluate != 0)
     {
-        updateChain();
+        if (bands != 0)
+            updateBandSections(bands);
+
+        for (int band = 0; band < BandResponseCache::numBands; ++band)
+        {
+            if (bandsToEvaluate & (1u << band))
+                updateBandResponse(band);
+        }
+
         updateResponseCurve();
     }
 
-    repaint();
+    needsRepaint = false;
+
+    // grid, labels and border live in cached layers, only the analysis area changes per frame
+    repaint(getAnalysisArea());
 }
 
-void ResponseCurveComponent::updateChain()
+void ResponseCurveComponent::updateBandSections(juce::uint32 bands)
 {
-    auto chainSettings = getChainSettings(audioProcessor.apvts);
-
-    monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    // monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    monoChain.setBypassed<ChainPositions::LowPeak>(chainSettings.lowPeakBypassed);
-    monoChain.setBypassed<ChainPositions::LowMidPeak>(chainSettings.lowMidPeakBypassed);
-    monoChain.setBypassed<ChainPositions::HighMidPeak>(chainSettings.highMidPeakBypassed);
-    monoChain.setBypassed<ChainPositions::HighPeak>(chainSettings.highPeakBypassed);
-    monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-
-    /*
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    */
+    const auto chainSettings = getChainSettings(audioProcessor.parameterHandles);
+    const auto panelBands = makePanelBands(chainSettings);
+    const auto bypassed = makePanelBypassed(chainSettings);
+    const auto sampleRate = audioProcessor.getSampleRate();
 
-    auto lowPeakCoefficients = makeLowPeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::LowPeak>().coefficients, lowPeakCoefficients);
+    for (size_t band = 0; band < panelBands.size(); ++band)
+    {
+        if ((bands & (1u << band)) == 0)
+            continue;
 
-    auto lowMidPeakCoefficients = makeLowMidPeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::LowMidPeak>().coefficients, lowMidPeakCoefficients);
+        // the design the audio thread runs, so the curve can't drift from what is heard
+        numBandSections[band] = bypassed[band] ? 0 : BiquadBank::design(panelBands[band], sampleRate, bandSections[band].data());
 
-    auto highMidPeakCoefficients = makeHighMidPeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::HighMidPeak>().coefficients, highMidPeakCoefficients);
+        designedBands[band] = panelBands[band];
+        designedBypassed[band] = bypassed[band];
+    }
+}
 
-    auto highPeakCoefficients = makeHighPeakFilter(chainSettings, audioProcessor.getSampleRate());
-    updateCoefficients(monoChain.get<ChainPositions::HighPeak>().coefficients, highPeakCoefficients);
+juce::uint32 ResponseCurveComponent::getOutdatedBands() const
+{
+    const auto chainSettings = getChainSettings(audioProcessor.parameterHandles);
+    const auto panelBands = makePanelBands(chainSettings);
+    const auto bypassed = makePanelBypassed(chainSettings);
 
-    auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
+    juce::uint32 bands = 0;
 
-    updateCutFilter(monoChain.get<ChainPositions::LowCut>(),
-                    lowCutCoefficients,
-                    chainSettings.lowCutSlope);
+    for (size_t band = 0; band < panelBands.size(); ++band)
+    {
+        if (panelBands[band] != designedBands[band] || bypassed[band] != designedBypassed[band])
+            bands |= 1u << band;
+    }
 
-    updateCutFilter(monoChain.get<ChainPositions::HighCut>(),
-                    highCutCoefficients,
-                    chainSettings.highCutSlope);
+    return bands;
 }
 
 juce::Rectangle<int> ResponseCurveComponent::getRenderArea()
@@ -621,95 +1129,309 @@ juce::Rectangle<int> ResponseCurveComponent::getAnalysisArea()
 }
 
 //==============================================================================
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+void PathProducer::prepare()
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
-    while (leftChannelFifo->getNumCompleteBuffersAvailable() > 0)
+    preparedMultiResolution = multiResolution;
+
+    // the engine and window come from FFTResourceCache, so only the first analyzer pays for them
+    if (preparedMultiResolution)
+        multiResolutionAnalyzer.prepare(FFTOrder::order2048);
+    else
+        leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
+
+    monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
+    latestFFTData.assign(getFFTSize() / 2, -48.f);
+}
+
+void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate, bool renderPath)
+{
+    SPECTRUMEQ_TRACE_SCOPE("PathProducer::process");
+
+    if (!isPrepared())
+        prepare();
+
+    while (auto* incomingBuffer = leftChannelFifo->getAudioBuffer())
     {
-        if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
+        auto size = incomingBuffer->getNumSamples();
+
+        if (preparedMultiResolution)
         {
-            auto size = tempIncomingBuffer.getNumSamples();
+            multiResolutionAnalyzer.pushSamples(incomingBuffer->getReadPointer(0), size, -48.f);
+            continue;
+        }
 
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
-                monoBuffer.getReadPointer(0, size),
-                monoBuffer.getNumSamples() - size);
+        juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, 0),
+            monoBuffer.getReadPointer(0, size),
+            monoBuffer.getNumSamples() - size);
 
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-                tempIncomingBuffer.getReadPointer(0, 0),
-                size);
+        juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
+            incomingBuffer->getReadPointer(0, 0),
+            size);
 
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
-        }
+        leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
     }
 
-    const auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
+    const auto fftSize = getFFTSize();
     const auto binWidth = sampleRate / double(fftSize);
 
-    while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
+    auto nextFFTData = [this]
     {
-        std::vector<float> fftData;
-        if (leftChannelFFTDataGenerator.getFFTData(fftData))
-        {
-            pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
-        }
+        return preparedMultiResolution ? multiResolutionAnalyzer.getFFTData() : leftChannelFFTDataGenerator.getFFTData();
+    };
+
+    numNewSpectra = 0;
+
+    while (auto* fftData = nextFFTData())
+    {
+        if ((size_t)numNewSpectra == newSpectra.size())
+            newSpectra.emplace_back();
+
+        newSpectra[(size_t)numNewSpectra++] = *fftData;
     }
 
-    while (pathProducer.getNumPathsAvailable() > 0)
+    const auto hasNewFFTData = numNewSpectra > 0;
+
+    if (hasNewFFTData)
+        latestFFTData = newSpectra[(size_t)numNewSpectra - 1];
+
+    if (hasNewFFTData)
     {
-        pathProducer.getPath(leftChannelFFTPath);
+        if (renderPath)
+            renderDataGenerator.generateRenderData(latestFFTData, fftBounds, fftSize, binWidth, -48.f);
+
+        lastFrameWasSilent = std::all_of(latestFFTData.begin(), latestFFTData.begin() + fftSize / 2,
+                                         [](float v) { return v <= -48.f; });
     }
 }
 
+//==============================================================================
+SpectrogramComponent::SpectrogramComponent()
+{
+    setOpaque(true);
+}
+
+void SpectrogramComponent::visibilityChanged()
+{
+    resized();
+}
+
+void SpectrogramComponent::buildColourLut()
+{
+    using namespace juce;
+
+    ColourGradient gradient(Colours::black, 0.f, 0.f, Colours::white, 1.f, 0.f, false);
+    gradient.addColour(0.35, Colour(97u, 18u, 167u));
+    gradient.addColour(0.65, Colours::orange);
+    gradient.addColour(0.85, Colours::yellow);
+
+    for (int i = 0; i < lutSize; ++i)
+        colourLut[i] = gradient.getColourAtPosition(double(i) / double(lutSize - 1)).getPixelARGB();
+
+    lutBuilt = true;
+}
+
+void SpectrogramComponent::pushSpectra(const std::vector<float>& leftSpectrum,
+                                       const std::vector<float>& rightSpectrum,
+                                       int fftSize,
+                                       float binWidth,
+                                       float negativeInfinity)
+{
+    using namespace juce;
+
+    if (history.isNull() || fftSize < 4)
+        return;
+
+    const auto numRows = history.getHeight();
+
+    if (!rowMap.matches(fftSize, binWidth, numRows))
+        rowMap.build(fftSize, binWidth, numRows);
+
+    Image::BitmapData column(history, writeColumn, 0, 1, numRows, Image::BitmapData::writeOnly);
+
+    for (int row = 0; row < numRows; ++row)
+    {
+        auto v = jmax(rowMap.getValue(leftSpectrum, row, BinReduction::Max),
+                      rowMap.getValue(rightSpectrum, row, BinReduction::Max));
+
+        if (std::isnan(v))
+            v = negativeInfinity;
+
+        auto index = (int)jlimit(0.f, float(lutSize - 1), jmap(v, negativeInfinity, 0.f, 0.f, float(lutSize - 1)));
+
+        // row 0 is 20 Hz, which is drawn at the bottom
+        reinterpret_cast<PixelARGB*>(column.getPixelPointer(0, numRows - 1 - row))->set(colourLut[index]);
+    }
+
+    writeColumn = (writeColumn + 1) % history.getWidth();
+
+    repaint();
+}
+
+void SpectrogramComponent::paint(juce::Graphics& g)
+{
+    SPECTRUMEQ_TRACE_SCOPE("SpectrogramComponent::paint");
+
+    using namespace juce;
+
+    if (history.isNull())
+    {
+        g.fillAll(Colours::black);
+        return;
+    }
+
+    const auto w = history.getWidth();
+    const auto h = history.getHeight();
+
+    // columns [writeColumn, w) are the oldest and go on the left, [0, writeColumn) follow them
+    g.drawImage(history, 0, 0, w - writeColumn, h, writeColumn, 0, w - writeColumn, h);
+
+    if (writeColumn > 0)
+        g.drawImage(history, w - writeColumn, 0, writeColumn, h, 0, 0, writeColumn, h);
+
+    g.setColour(Colours::orange);
+    g.drawRect(getLocalBounds());
+}
+
+//==============================================================================
+LevelMeterComponent::LevelMeterComponent(SpectrumEQAudioProcessor& p) : audioProcessor(p)
+{
+    setOpaque(true);
+}
+
+void LevelMeterComponent::onVBlank()
+{
+    if (!isShowing())
+        return;
+
+    const auto reading = audioProcessor.levelMeters.read(reader);
+
+    // nothing new while the host isn't processing; the meters just hold
+    if (reading.numSamples == 0)
+        return;
+
+    ballistics.update(reading, audioProcessor.getSampleRate());
+    repaint();
+}
+
+void LevelMeterComponent::mouseDown(const juce::MouseEvent&)
+{
+    ballistics.resetClips();
+    repaint();
+}
+
+void LevelMeterComponent::paint(juce::Graphics& g)
+{
+    using namespace juce;
+
+    g.fillAll(Colours::black);
+
+    auto bounds = getLocalBounds().reduced(2);
+    auto labelArea = bounds.removeFromBottom(12);
+    auto clipArea = bounds.removeFromTop(6);
+    bounds.removeFromTop(2);
+
+    auto dbToY = [&](float db)
+    {
+        return jmap(jlimit(minDb, maxDb, db), minDb, maxDb, (float)bounds.getBottom(), (float)bounds.getY());
+    };
+
+    const auto barWidth = bounds.getWidth() / numMeterChannels;
+
+    g.setFont(10);
+
+    for (int ch = 0; ch < numMeterChannels; ++ch)
+    {
+        // a gap between the input pair and the output pair
+        const auto x = bounds.getX() + ch * barWidth + (ch >= MeterChannel::OutputLeft ? 2 : 0);
+        const auto bar = Rectangle<int>(x, bounds.getY(), barWidth - 2, bounds.getHeight()).toFloat();
+
+        g.setColour(Colours::darkgrey.darker());
+        g.fillRect(bar);
+
+        const auto rmsTop = dbToY(ballistics.getRmsDb(ch));
+        g.setColour(Colour(0u, 172u, 1u));
+        g.fillRect(bar.withTop(rmsTop));
+
+        g.setColour(Colours::white);
+        g.fillRect(bar.withTop(dbToY(ballistics.getPeakDb(ch))).withHeight(1.f));
+
+        g.setColour(ballistics.getPeakHoldDb(ch) >= 0.f ? Colours::red : Colours::yellow);
+        g.fillRect(bar.withTop(dbToY(ballistics.getPeakHoldDb(ch))).withHeight(2.f));
+
+        g.setColour(ballistics.getNumClips(ch) > 0 ? Colours::red : Colours::dimgrey);
+        g.fillRect(Rectangle<int>(x, clipArea.getY(), barWidth - 2, clipArea.getHeight()));
+    }
+
+    // 0 dBFS
+    g.setColour(Colours::grey);
+    g.drawHorizontalLine(roundToInt(dbToY(0.f)), (float)bounds.getX(), (float)bounds.getRight());
+
+    g.setColour(Colours::lightgrey);
+    g.drawFittedText("IN", labelArea.removeFromLeft(labelArea.getWidth() / 2), Justification::centred, 1);
+    g.drawFittedText("OUT", labelArea, Justification::centred, 1);
+}
+
+void SpectrogramComponent::resized()
+{
+    using namespace juce;
+
+    history = {};
+    writeColumn = 0;
+
+    if (!isVisible() || getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    if (!lutBuilt)
+        buildColourLut();
+
+    history = Image(Image::ARGB, getWidth(), getHeight(), false);
+    history.clear(history.getBounds(), Colours::black);
+}
+
 //==============================================================================
 SpectrumEQAudioProcessorEditor::SpectrumEQAudioProcessorEditor (SpectrumEQAudioProcessor& p) : 
       AudioProcessorEditor (&p), audioProcessor (p), 
 
-      lowPeakFreqSlider(*audioProcessor.apvts.getParameter("Low Peak Freq"), "Hz"),
-      lowPeakGainSlider(*audioProcessor.apvts.getParameter("Low Peak Gain"), "dB"),
-      lowPeakQualitySlider(*audioProcessor.apvts.getParameter("Low Peak Quality"), ""),
-      lowMidPeakFreqSlider(*audioProcessor.apvts.getParameter("LowMid Peak Freq"), "Hz"),
-      lowMidPeakGainSlider(*audioProcessor.apvts.getParameter("LowMid Peak Gain"), "dB"),
-      lowMidPeakQualitySlider(*audioProcessor.apvts.getParameter("LowMid Peak Quality"), ""),
-      highMidPeakFreqSlider(*audioProcessor.apvts.getParameter("HighMid Peak Freq"), "Hz"),
-      highMidPeakGainSlider(*audioProcessor.apvts.getParameter("HighMid Peak Gain"), "dB"),
-      highMidPeakQualitySlider(*audioProcessor.apvts.getParameter("HighMid Peak Quality"), ""),
-      highPeakFreqSlider(*audioProcessor.apvts.getParameter("High Peak Freq"), "Hz"),
-      highPeakGainSlider(*audioProcessor.apvts.getParameter("High Peak Gain"), "dB"),
-      highPeakQualitySlider(*audioProcessor.apvts.getParameter("High Peak Quality"), ""),
-
-      lowCutFreqSlider(*audioProcessor.apvts.getParameter("LowCut Freq"), "Hz"),
-      highCutFreqSlider(*audioProcessor.apvts.getParameter("HighCut Freq"), "Hz"),
-      lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Slope"), "dB/Oct"),
-      highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope"), "dB/Oct"),
+      lowPeakFreqSlider(audioProcessor.apvts, LowPeakFreq),
+      lowPeakGainSlider(audioProcessor.apvts, LowPeakGain),
+      lowPeakQualitySlider(audioProcessor.apvts, LowPeakQuality),
+      lowMidPeakFreqSlider(audioProcessor.apvts, LowMidPeakFreq),
+      lowMidPeakGainSlider(audioProcessor.apvts, LowMidPeakGain),
+      lowMidPeakQualitySlider(audioProcessor.apvts, LowMidPeakQuality),
+      highMidPeakFreqSlider(audioProcessor.apvts, HighMidPeakFreq),
+      highMidPeakGainSlider(audioProcessor.apvts, HighMidPeakGain),
+      highMidPeakQualitySlider(audioProcessor.apvts, HighMidPeakQuality),
+      highPeakFreqSlider(audioProcessor.apvts, HighPeakFreq),
+      highPeakGainSlider(audioProcessor.apvts, HighPeakGain),
+      highPeakQualitySlider(audioProcessor.apvts, HighPeakQuality),
+
+      lowCutFreqSlider(audioProcessor.apvts, LowCutFreq),
+      highCutFreqSlider(audioProcessor.apvts, HighCutFreq),
+      lowCutSlopeSlider(audioProcessor.apvts, LowCutSlope),
+      highCutSlopeSlider(audioProcessor.apvts, HighCutSlope),
       
       responseCurveComponent(audioProcessor),
-      lowPeakFreqSliderAttachment(audioProcessor.apvts, "Low Peak Freq", lowPeakFreqSlider),
-      lowPeakGainSliderAttachment(audioProcessor.apvts, "Low Peak Gain", lowPeakGainSlider),
-      lowPeakQualitySliderAttachment(audioProcessor.apvts, "Low Peak Quality", lowPeakQualitySlider),
-      lowMidPeakFreqSliderAttachment(audioProcessor.apvts, "LowMid Peak Freq", lowMidPeakFreqSlider),
-      lowMidPeakGainSliderAttachment(audioProcessor.apvts, "LowMid Peak Gain", lowMidPeakGainSlider),
-      lowMidPeakQualitySliderAttachment(audioProcessor.apvts, "LowMid Peak Quality", lowMidPeakQualitySlider),
-      highMidPeakFreqSliderAttachment(audioProcessor.apvts, "HighMid Peak Freq", highMidPeakFreqSlider),
-      highMidPeakGainSliderAttachment(audioProcessor.apvts, "HighMid Peak Gain", highMidPeakGainSlider),
-      highMidPeakQualitySliderAttachment(audioProcessor.apvts, "HighMid Peak Quality", highMidPeakQualitySlider),
-      highPeakFreqSliderAttachment(audioProcessor.apvts, "High Peak Freq", highPeakFreqSlider),
-      highPeakGainSliderAttachment(audioProcessor.apvts, "High Peak Gain", highPeakGainSlider),
-      highPeakQualitySliderAttachment(audioProcessor.apvts, "High Peak Quality", highPeakQualitySlider),
-
-      lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
-      highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
-      lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
-      highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider),
-
-      lowcutBypassButtonAttachment(audioProcessor.apvts, "LowCut Bypassed", lowcutBypassButton),
-      lowPeakBypassButtonAttachment(audioProcessor.apvts, "Low Peak Bypassed", lowPeakBypassButton),
-      lowMidPeakBypassButtonAttachment(audioProcessor.apvts, "LowMid Peak Bypassed", lowMidPeakBypassButton),
-      highMidPeakBypassButtonAttachment(audioProcessor.apvts, "HighMid Peak Bypassed", highMidPeakBypassButton),
-      highPeakBypassButtonAttachment(audioProcessor.apvts, "High Peak Bypassed", highPeakBypassButton),
-
-      highcutBypassButtonAttachment(audioProcessor.apvts, "HighCut Bypassed", highcutBypassButton),
-      analyzerEnabledButtonAttachment(audioProcessor.apvts, "Analyzer Enabled", analyzerEnabledButton)
+      levelMeterComponent(audioProcessor)
 {
+    // the items have to be there before the attachments pick up the current choice
+    for (auto* box : { &lowCutRoutingBox, &lowPeakRoutingBox, &lowMidPeakRoutingBox, &highMidPeakRoutingBox, &highPeakRoutingBox, &highCutRoutingBox })
+        box->addItemList(getRoutingChoices(), 1);
+
+    for (int i = 0; i < NumParameters; ++i)
+    {
+        auto* comp = getComponentForParameter(static_cast<ParameterIndex>(i));
+
+        if (auto* slider = dynamic_cast<juce::Slider*>(comp))
+            sliderAttachments.push_back(std::make_unique<Attachment>(audioProcessor.apvts, parameterTable[i].id, *slider));
+        else if (auto* button = dynamic_cast<juce::Button*>(comp))
+            buttonAttachments.push_back(std::make_unique<ButtonAttachment>(audioProcessor.apvts, parameterTable[i].id, *button));
+        else if (auto* box = dynamic_cast<juce::ComboBox*>(comp))
+            comboBoxAttachments.push_back(std::make_unique<ComboBoxAttachment>(audioProcessor.apvts, parameterTable[i].id, *box));
+    }
+
+    // after the attachments, which set the sliders' text functions of their own
+    setupDynamicsSliders();
+
     lowPeakFreqSlider.labels.add({ 0.f, "60 Hz" });
     lowPeakFreqSlider.labels.add({ 1.f, "200 Hz" });
 
@@ -763,13 +1485,24 @@ SpectrumEQAudioProcessorEditor::SpectrumEQAudioProcessorEditor (SpectrumEQAudioP
         addAndMakeVisible(comp);
     }
 
-    lowPeakBypassButton.setLookAndFeel(&lnf);
-    lowMidPeakBypassButton.setLookAndFeel(&lnf);
-    highMidPeakBypassButton.setLookAndFeel(&lnf);
-    highPeakBypassButton.setLookAndFeel(&lnf);
-    lowcutBypassButton.setLookAndFeel(&lnf);
-    highcutBypassButton.setLookAndFeel(&lnf);
-    analyzerEnabledButton.setLookAndFeel(&lnf);
+    addChildComponent(spectrogramComponent);
+    addAndMakeVisible(spectrogramEnabledButton);
+    addAndMakeVisible(phaseButton);
+    addAndMakeVisible(groupDelayButton);
+    addAndMakeVisible(analyzerResolutionBox);
+    addAndMakeVisible(analyzerFillButton);
+    addAndMakeVisible(presetSlotBox);
+    addAndMakeVisible(storePresetButton);
+    addAndMakeVisible(levelMeterComponent);
+    responseCurveComponent.setSpectrogram(&spectrogramComponent);
+
+    lowPeakBypassButton.setLookAndFeel(&lnf.get());
+    lowMidPeakBypassButton.setLookAndFeel(&lnf.get());
+    highMidPeakBypassButton.setLookAndFeel(&lnf.get());
+    highPeakBypassButton.setLookAndFeel(&lnf.get());
+    lowcutBypassButton.setLookAndFeel(&lnf.get());
+    highcutBypassButton.setLookAndFeel(&lnf.get());
+    analyzerEnabledButton.setLookAndFeel(&lnf.get());
 
     auto safePtr = juce::Component::SafePointer<SpectrumEQAudioProcessorEditor>(this);
     lowPeakBypassButton.onClick = [safePtr]()
@@ -781,6 +1514,9 @@ SpectrumEQAudioProcessorEditor::SpectrumEQAudioProcessorEditor (SpectrumEQAudioP
             comp->lowPeakFreqSlider.setEnabled(!bypassed);
             comp->lowPeakGainSlider.setEnabled(!bypassed);
             comp->lowPeakQualitySlider.setEnabled(!bypassed);
+
+            for (auto* slider : comp->getDynamicsSliders(0))
+                slider->setEnabled(!bypassed);
         }
     };
 
@@ -793,6 +1529,9 @@ SpectrumEQAudioProcessorEditor::SpectrumEQAudioProcessorEditor (SpectrumEQAudioP
             comp->lowMidPeakFreqSlider.setEnabled(!bypassed);
             comp->lowMidPeakGainSlider.setEnabled(!bypassed);
             comp->lowMidPeakQualitySlider.setEnabled(!bypassed);
+
+            for (auto* slider : comp->getDynamicsSliders(1))
+                slider->setEnabled(!bypassed);
         }
     };
 
@@ -805,6 +1544,9 @@ SpectrumEQAudioProcessorEditor::SpectrumEQAudioProcessorEditor (SpectrumEQAudioP
             comp->highMidPeakFreqSlider.setEnabled(!bypassed);
             comp->highMidPeakGainSlider.setEnabled(!bypassed);
             comp->highMidPeakQualitySlider.setEnabled(!bypassed);
+
+            for (auto* slider : comp->getDynamicsSliders(2))
+                slider->setEnabled(!bypassed);
         }
     };
 
@@ -817,6 +1559,9 @@ SpectrumEQAudioProcessorEditor::SpectrumEQAudioProcessorEditor (SpectrumEQAudioP
             comp->highPeakFreqSlider.setEnabled(!bypassed);
             comp->highPeakGainSlider.setEnabled(!bypassed);
             comp->highPeakQualitySlider.setEnabled(!bypassed);
+
+            for (auto* slider : comp->getDynamicsSliders(3))
+                slider->setEnabled(!bypassed);
         }
     };
 
@@ -851,11 +1596,84 @@ SpectrumEQAudioProcessorEditor::SpectrumEQAudioProcessorEditor (SpectrumEQAudioP
         }
     };
 
+    // the attachment set the toggle before onClick existed, so a disabled analyzer never builds its FFT
+    responseCurveComponent.toggleAnalysisEnablement(analyzerEnabledButton.getToggleState());
+
+    spectrogramEnabledButton.onClick = [safePtr]()
+    {
+        if (auto* comp = safePtr.getComponent())
+        {
+            comp->spectrogramComponent.setVisible(comp->spectrogramEnabledButton.getToggleState());
+            comp->resized();
+        }
+    };
+
+    phaseButton.onClick = groupDelayButton.onClick = [safePtr]()
+    {
+        if (auto* comp = safePtr.getComponent())
+            comp->responseCurveComponent.setOverlays(comp->phaseButton.getToggleState(), comp->groupDelayButton.getToggleState());
+    };
+
+    analyzerResolutionBox.addItem("Single FFT", 1);
+    analyzerResolutionBox.addItem("Multi-Res Tone", 2);
+    analyzerResolutionBox.addItem("Multi-Res Noise", 3);
+    analyzerResolutionBox.setSelectedId(1, juce::dontSendNotification);
+
+    analyzerResolutionBox.onChange = [safePtr]()
+    {
+        if (auto* comp = safePtr.getComponent())
+        {
+            const auto id = comp->analyzerResolutionBox.getSelectedId();
+            const auto normalisation = id == 3 ? MultiResolutionAnalyzer::Normalisation::Noise : MultiResolutionAnalyzer::Normalisation::Tone;
+
+            comp->responseCurveComponent.setAnalyzerMultiResolution(id != 1, normalisation);
+
+            // exported frames follow what is on screen
+            if (comp->audioProcessor.frameExportTap != nullptr)
+                comp->audioProcessor.frameExportTap->setMode((AnalyzerFrameExport::Mode)(id - 1));
+        }
+    };
+
+    analyzerFillButton.onClick = [safePtr]()
+    {
+        if (auto* comp = safePtr.getComponent())
+            comp->responseCurveComponent.setAnalyzerFilled(comp->analyzerFillButton.getToggleState());
+    };
+
+    presetSlotBox.setTextWhenNothingSelected("Preset");
+    refreshPresetSlots();
+
+    presetSlotBox.onChange = [safePtr]()
+    {
+        // an empty slot is only picked to store into
+        if (auto* comp = safePtr.getComponent())
+            comp->audioProcessor.recallPreset(comp->presetSlotBox.getSelectedId() - 1);
+    };
+
+    // the box catches up through presetChanges, whoever stored or recalled
+    storePresetButton.onClick = [safePtr]()
+    {
+        if (auto* comp = safePtr.getComponent())
+            comp->audioProcessor.storePreset(juce::jmax(0, comp->presetSlotBox.getSelectedId() - 1));
+    };
+
+    audioProcessor.presetChanges.addChangeListener(this);
+
    // setSize(480, 500);
     setSize(800, 600);
+
+    setWantsKeyboardFocus(true);
+
+    openTiming.constructionFinished();
 }
 
 SpectrumEQAudioProcessorEditor::~SpectrumEQAudioProcessorEditor() {
+    audioProcessor.presetChanges.removeChangeListener(this);
+
+    // without an editor the export goes back to the box's default, which the next editor starts at
+    if (audioProcessor.frameExportTap != nullptr)
+        audioProcessor.frameExportTap->setMode(AnalyzerFrameExport::Mode::Single);
+
     lowPeakBypassButton.setLookAndFeel(nullptr);
     lowMidPeakBypassButton.setLookAndFeel(nullptr);
     highMidPeakBypassButton.setLookAndFeel(nullptr);
@@ -868,6 +1686,8 @@ SpectrumEQAudioProcessorEditor::~SpectrumEQAudioProcessorEditor() {
 //==============================================================================
 void SpectrumEQAudioProcessorEditor::paint(juce::Graphics& g)
 {
+    SPECTRUMEQ_TRACE_SCOPE("SpectrumEQAudioProcessorEditor::paint");
+
     using namespace juce;
 
     g.fillAll(juce::Colours::black);
@@ -882,6 +1702,89 @@ void SpectrumEQAudioProcessorEditor::paint(juce::Graphics& g)
     g.drawFittedText("HighCut", highCutSlopeSlider.getBounds(), juce::Justification::centredBottom, 1);
 }
 
+bool SpectrumEQAudioProcessorEditor::keyPressed(const juce::KeyPress& key)
+{
+    using namespace juce;
+
+    const auto modifiers = ModifierKeys::commandModifier | ModifierKeys::shiftModifier;
+
+    if (key == KeyPress('p', modifiers, 0))
+    {
+        for (auto scale : { 1.f, 2.f })
+        {
+            const auto m = responseCurveComponent.measurePaint(300, scale);
+
+            Logger::writeToLog("ResponseCurveComponent::paint at " + String(m.scale, 0) + "x over " + String(m.numFrames)
+                               + " frames: " + String(m.uncachedMs, 3) + " ms drawing every layer on the whole component, "
+                               + String(m.cachedMs, 3) + " ms from cached layers on the analysis area");
+        }
+
+        // shared by every analyzer in the process, this editor's and any other instance's
+        Logger::writeToLog("FFTResourceCache: " + FFTResourceCache::getStats().toString());
+
+        return true;
+    }
+
+   #if SPECTRUMEQ_TRACE
+    if (key == KeyPress('t', modifiers, 0))
+    {
+        const auto file = File::getSpecialLocation(File::userDesktopDirectory)
+                              .getNonexistentChildFile("SpectrumEQ-trace-" + Time::getCurrentTime().formatted("%Y%m%d-%H%M%S"), ".json");
+
+        // traced builds can be release builds, where DBG would say nothing
+        Logger::writeToLog("EventTrace: " + String(EventTrace::writeChromeJson(file) ? "wrote " : "couldn't write ") + file.getFullPathName());
+        return true;
+    }
+   #endif
+
+    return false;
+}
+
+void SpectrumEQAudioProcessorEditor::paintOverChildren(juce::Graphics&)
+{
+    // called once the children have painted too, so this is the end of the first complete frame
+    if (!openTiming.hasPainted())
+        openTiming.firstPaintFinished();
+}
+
+void SpectrumEQAudioProcessorEditor::refreshPresetSlots()
+{
+    // the processor's current slot once there is one, so a program the host picked shows too.
+    // before that, storing into an unpicked box goes to slot 1, so that's what it shows afterwards
+    const auto currentSlot = audioProcessor.getCurrentPresetSlot();
+    const auto selectedId = currentSlot >= 0 ? currentSlot + 1 : juce::jmax(1, presetSlotBox.getSelectedId());
+
+    presetSlotBox.clear(juce::dontSendNotification);
+
+    for (int slot = 0; slot < PresetBank::numSlots; ++slot)
+    {
+        const auto name = "Slot " + juce::String(slot + 1);
+        presetSlotBox.addItem(audioProcessor.isPresetStored(slot) ? name : name + " (empty)", slot + 1);
+    }
+
+    if (audioProcessor.isPresetStored(selectedId - 1))
+        presetSlotBox.setSelectedId(selectedId, juce::dontSendNotification);
+}
+
+// one bar per row, at the bottom of a peak band's column
+static constexpr int dynamicsRowHeight = 18;
+static constexpr int dynamicsHeight = 4 * dynamicsRowHeight + 4;
+
+static void layoutDynamics(const std::array<juce::Slider*, 4>& sliders, juce::Rectangle<int> area)
+{
+    area.removeFromTop(4);
+
+    for (auto* slider : sliders)
+        slider->setBounds(area.removeFromTop(dynamicsRowHeight).reduced(4, 1));
+}
+
+// bypass on the left of the band's header, routing on the right
+static void layoutBandHeader(juce::Button& bypassButton, juce::ComboBox& routingBox, juce::Rectangle<int> header)
+{
+    routingBox.setBounds(header.removeFromRight(header.getWidth() / 2).reduced(2));
+    bypassButton.setBounds(header);
+}
+
 void SpectrumEQAudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds();
@@ -894,11 +1797,30 @@ void SpectrumEQAudioProcessorEditor::resized()
 
     analyzerEnabledButton.setBounds(analyzerEnabledArea);
 
+    spectrogramEnabledButton.setBounds(analyzerEnabledArea.withX(analyzerEnabledArea.getRight() + 10));
+    phaseButton.setBounds(spectrogramEnabledButton.getBounds().withX(spectrogramEnabledButton.getRight()).withWidth(60));
+    groupDelayButton.setBounds(phaseButton.getBounds().withX(phaseButton.getRight()).withWidth(90));
+    analyzerResolutionBox.setBounds(groupDelayButton.getBounds().withX(groupDelayButton.getRight() + 2).withWidth(100));
+    analyzerFillButton.setBounds(analyzerResolutionBox.getBounds().withX(analyzerResolutionBox.getRight() + 2).withWidth(50));
+    presetSlotBox.setBounds(analyzerFillButton.getBounds().withX(analyzerFillButton.getRight() + 5).withWidth(70));
+    storePresetButton.setBounds(presetSlotBox.getBounds().withX(presetSlotBox.getRight() + 2).withWidth(45));
+
+    auto autoGainArea = analyzerEnabledArea.withX(getWidth() - 5 - 150).withWidth(85);
+    autoGainButton.setBounds(autoGainArea);
+    autoGainFreezeButton.setBounds(autoGainArea.withX(autoGainArea.getRight()).withWidth(65));
+
     bounds.removeFromTop(5);
 
     float hRatio = 27.f / 100.f; // JUCE_LIVE_CONSTANT(33) / 100.f;
     auto responseArea = bounds.removeFromTop(bounds.getHeight() * hRatio);
 
+    levelMeterComponent.setBounds(responseArea.removeFromRight(50).withTrimmedLeft(5));
+
+    if (spectrogramComponent.isVisible())
+    {
+        spectrogramComponent.setBounds(responseArea.removeFromRight(responseArea.getWidth() / 3).withTrimmedLeft(5));
+    }
+
     responseCurveComponent.setBounds(responseArea);
 
     bounds.removeFromTop(5);
@@ -911,35 +1833,146 @@ void SpectrumEQAudioProcessorEditor::resized()
     auto highCutArea = bounds;
 
 
-    lowcutBypassButton.setBounds(lowCutArea.removeFromTop(25));
+    layoutBandHeader(lowcutBypassButton, lowCutRoutingBox, lowCutArea.removeFromTop(25));
     lowCutFreqSlider.setBounds(lowCutArea.removeFromTop(lowCutArea.getHeight() * 0.5));
     lowCutSlopeSlider.setBounds(lowCutArea);
 
-    lowPeakBypassButton.setBounds(lowPeakArea.removeFromTop(25));
+    layoutBandHeader(lowPeakBypassButton, lowPeakRoutingBox, lowPeakArea.removeFromTop(25));
+    layoutDynamics(getDynamicsSliders(0), lowPeakArea.removeFromBottom(dynamicsHeight));
     lowPeakFreqSlider.setBounds(lowPeakArea.removeFromTop(lowPeakArea.getHeight() * 0.33));
     lowPeakGainSlider.setBounds(lowPeakArea.removeFromTop(lowPeakArea.getHeight() * 0.5));
     lowPeakQualitySlider.setBounds(lowPeakArea);
 
-    lowMidPeakBypassButton.setBounds(lowMidPeakArea.removeFromTop(25));
+    layoutBandHeader(lowMidPeakBypassButton, lowMidPeakRoutingBox, lowMidPeakArea.removeFromTop(25));
+    layoutDynamics(getDynamicsSliders(1), lowMidPeakArea.removeFromBottom(dynamicsHeight));
     lowMidPeakFreqSlider.setBounds(lowMidPeakArea.removeFromTop(lowMidPeakArea.getHeight() * 0.33));
     lowMidPeakGainSlider.setBounds(lowMidPeakArea.removeFromTop(lowMidPeakArea.getHeight() * 0.5));
     lowMidPeakQualitySlider.setBounds(lowMidPeakArea);
 
-    highMidPeakBypassButton.setBounds(highMidPeakArea.removeFromTop(25));
+    layoutBandHeader(highMidPeakBypassButton, highMidPeakRoutingBox, highMidPeakArea.removeFromTop(25));
+    layoutDynamics(getDynamicsSliders(2), highMidPeakArea.removeFromBottom(dynamicsHeight));
     highMidPeakFreqSlider.setBounds(highMidPeakArea.removeFromTop(highMidPeakArea.getHeight() * 0.33));
     highMidPeakGainSlider.setBounds(highMidPeakArea.removeFromTop(highMidPeakArea.getHeight() * 0.5));
     highMidPeakQualitySlider.setBounds(highMidPeakArea);
 
-    highPeakBypassButton.setBounds(highPeakArea.removeFromTop(25));
+    layoutBandHeader(highPeakBypassButton, highPeakRoutingBox, highPeakArea.removeFromTop(25));
+    layoutDynamics(getDynamicsSliders(3), highPeakArea.removeFromBottom(dynamicsHeight));
     highPeakFreqSlider.setBounds(highPeakArea.removeFromTop(highPeakArea.getHeight() * 0.33));
     highPeakGainSlider.setBounds(highPeakArea.removeFromTop(highPeakArea.getHeight() * 0.5));
     highPeakQualitySlider.setBounds(highPeakArea);
 
-    highcutBypassButton.setBounds(highCutArea.removeFromTop(25));
+    layoutBandHeader(highcutBypassButton, highCutRoutingBox, highCutArea.removeFromTop(25));
     highCutFreqSlider.setBounds(highCutArea.removeFromTop(highCutArea.getHeight() * 0.5));
     highCutSlopeSlider.setBounds(highCutArea);
 }
 
+juce::Component* SpectrumEQAudioProcessorEditor::getComponentForParameter(ParameterIndex index)
+{
+    switch (index)
+    {
+        case LowCutFreq:            return &lowCutFreqSlider;
+        case HighCutFreq:           return &highCutFreqSlider;
+        case LowPeakFreq:           return &lowPeakFreqSlider;
+        case LowPeakGain:           return &lowPeakGainSlider;
+        case LowPeakQuality:        return &lowPeakQualitySlider;
+        case LowMidPeakFreq:        return &lowMidPeakFreqSlider;
+        case LowMidPeakGain:        return &lowMidPeakGainSlider;
+        case LowMidPeakQuality:     return &lowMidPeakQualitySlider;
+        case HighMidPeakFreq:       return &highMidPeakFreqSlider;
+        case HighMidPeakGain:       return &highMidPeakGainSlider;
+        case HighMidPeakQuality:    return &highMidPeakQualitySlider;
+        case HighPeakFreq:          return &highPeakFreqSlider;
+        case HighPeakGain:          return &highPeakGainSlider;
+        case HighPeakQuality:       return &highPeakQualitySlider;
+        case LowCutSlope:           return &lowCutSlopeSlider;
+        case HighCutSlope:          return &highCutSlopeSlider;
+        case LowCutBypassed:        return &lowcutBypassButton;
+        case LowPeakBypassed:       return &lowPeakBypassButton;
+        case LowMidPeakBypassed:    return &lowMidPeakBypassButton;
+        case HighMidPeakBypassed:   return &highMidPeakBypassButton;
+        case HighPeakBypassed:      return &highPeakBypassButton;
+        case HighCutBypassed:       return &highcutBypassButton;
+        case AnalyzerEnabled:       return &analyzerEnabledButton;
+
+        case LowPeakThreshold:      return &lowPeakThresholdSlider;
+        case LowPeakRatio:          return &lowPeakRatioSlider;
+        case LowPeakAttack:         return &lowPeakAttackSlider;
+        case LowPeakRelease:        return &lowPeakReleaseSlider;
+        case LowMidPeakThreshold:   return &lowMidPeakThresholdSlider;
+        case LowMidPeakRatio:       return &lowMidPeakRatioSlider;
+        case LowMidPeakAttack:      return &lowMidPeakAttackSlider;
+        case LowMidPeakRelease:     return &lowMidPeakReleaseSlider;
+        case HighMidPeakThreshold:  return &highMidPeakThresholdSlider;
+        case HighMidPeakRatio:      return &highMidPeakRatioSlider;
+        case HighMidPeakAttack:     return &highMidPeakAttackSlider;
+        case HighMidPeakRelease:    return &highMidPeakReleaseSlider;
+        case HighPeakThreshold:     return &highPeakThresholdSlider;
+        case HighPeakRatio:         return &highPeakRatioSlider;
+        case HighPeakAttack:        return &highPeakAttackSlider;
+        case HighPeakRelease:       return &highPeakReleaseSlider;
+
+        case LowCutRouting:         return &lowCutRoutingBox;
+        case LowPeakRouting:        return &lowPeakRoutingBox;
+        case LowMidPeakRouting:     return &lowMidPeakRoutingBox;
+        case HighMidPeakRouting:    return &highMidPeakRoutingBox;
+        case HighPeakRouting:       return &highPeakRoutingBox;
+        case HighCutRouting:        return &highCutRoutingBox;
+
+        case AutoGainEnabled:       return &autoGainButton;
+        case AutoGainFreeze:        return &autoGainFreezeButton;
+
+        case NumParameters:         break;
+    }
+
+    jassertfalse;
+    return nullptr;
+}
+
+std::array<juce::Slider*, 4> SpectrumEQAudioProcessorEditor::getDynamicsSliders(int peakBand)
+{
+    static_assert(LowMidPeakThreshold == LowPeakThreshold + 4 && HighPeakRelease == LowPeakThreshold + 15,
+                  "each peak band's threshold, ratio, attack and release follow each other");
+
+    std::array<juce::Slider*, 4> sliders;
+
+    for (int i = 0; i < 4; ++i)
+        sliders[(size_t)i] = static_cast<juce::Slider*>(getComponentForParameter(static_cast<ParameterIndex>(LowPeakThreshold + 4 * peakBand + i)));
+
+    return sliders;
+}
+
+void SpectrumEQAudioProcessorEditor::setupDynamicsSliders()
+{
+    static constexpr const char* names[] = { "Thr", "Ratio", "Att", "Rel" };
+
+    for (int peakBand = 0; peakBand < DynamicPeakBands::numBands; ++peakBand)
+    {
+        const auto sliders = getDynamicsSliders(peakBand);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            const auto& spec = parameterTable[(size_t)(LowPeakThreshold + 4 * peakBand + i)];
+            auto* slider = sliders[(size_t)i];
+
+            const juce::String name(names[i]);
+            const juce::String unit(spec.unit);
+            const auto decimals = spec.interval < 1.f ? 1 : 0;
+
+            slider->setSliderStyle(juce::Slider::LinearBar);
+            slider->setTextBoxIsEditable(false);
+            slider->setColour(juce::Slider::trackColourId, juce::Colours::darkgrey);
+            slider->setColour(juce::Slider::textBoxTextColourId, juce::Colours::white);
+
+            slider->textFromValueFunction = [name, unit, decimals](double value)
+            {
+                return name + " " + juce::String(value, decimals) + (unit == ":1" ? unit : " " + unit);
+            };
+
+            slider->updateText();
+        }
+    }
+}
+
 std::vector<juce::Component*> SpectrumEQAudioProcessorEditor::getComps()
 {
     return
@@ -968,6 +2001,21 @@ std::vector<juce::Component*> SpectrumEQAudioProcessorEditor::getComps()
         &highMidPeakBypassButton,
         &highPeakBypassButton,
         &highcutBypassButton,
-        &analyzerEnabledButton
+        &analyzerEnabledButton,
+
+        &lowCutRoutingBox,
+        &lowPeakRoutingBox,
+        &lowMidPeakRoutingBox,
+        &highMidPeakRoutingBox,
+        &highPeakRoutingBox,
+        &highCutRoutingBox,
+
+        &autoGainButton,
+        &autoGainFreezeButton,
+
+        &lowPeakThresholdSlider, &lowPeakRatioSlider, &lowPeakAttackSlider, &lowPeakReleaseSlider,
+        &lowMidPeakThresholdSlider, &lowMidPeakRatioSlider, &lowMidPeakAttackSlider, &lowMidPeakReleaseSlider,
+        &highMidPeakThresholdSlider, &highMidPeakRatioSlider, &highMidPeakAttackSlider, &highMidPeakReleaseSlider,
+        &highPeakThresholdSlider, &highPeakRatioSlider, &highPeakAttackSlider, &highPeakReleaseSlider
     };
 }
\ No newline at end of file
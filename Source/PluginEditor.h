@@ -10,6 +10,9 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "FFTResourceCache.h"
+#include "MultiResolutionAnalyzer.h"
+#include "SpectrumRasteriser.h"
 
 enum FFTOrder
 {
@@ -33,10 +36,10 @@ struct FFTDataGenerator
         std::copy(readIndex, readIndex + fftSize, fftData.begin());
 
         // first apply a windowing function to our data
-        window->multiplyWithWindowingTable(fftData.data(), fftSize);       // [1]
+        juce::FloatVectorOperations::multiply(fftData.data(), resources->window.data(), fftSize);   // [1]
 
         // then render our FFT data..
-        forwardFFT->performFrequencyOnlyForwardTransform(fftData.data());  // [2]
+        resources->fft.performFrequencyOnlyForwardTransform(fftData.data());                        // [2]
 
         int numBins = (int)fftSize / 2;
 
@@ -55,13 +58,15 @@ struct FFTDataGenerator
             fftData[i] = v;
         }
 
-        //convert them to decibels
+        //convert them to decibels, straight into the fifo
+        auto& spectrum = fftDataFifo.getWriteSlot();
+
         for (int i = 0; i < numBins; ++i)
         {
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
+            spectrum[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
         }
 
-        fftDataFifo.push(fftData);
+        fftDataFifo.publish();
     }
 
     void changeOrder(FFTOrder newOrder)
@@ -73,36 +78,139 @@ struct FFTDataGenerator
         order = newOrder;
         auto fftSize = getFFTSize();
 
-        forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris);
+        // shared with every other analyzer in the process using this order
+        resources = FFTResourceCache::acquire(order, juce::dsp::WindowingFunction<float>::blackmanHarris);
 
         fftData.clear();
         fftData.resize(fftSize * 2, 0);
 
-        fftDataFifo.prepare(fftData.size());
+        // only the fftSize / 2 dB values are queued, not the whole transform workspace
+        fftDataFifo.prepare((size_t)fftSize / 2);
     }
     //==============================================================================
     int getFFTSize() const { return 1 << order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading(); }
     //==============================================================================
-    bool getFFTData(BlockType& fftData) { return fftDataFifo.pull(fftData); }
+    // the oldest queued spectrum, or nullptr. valid until a later call returns another one
+    const BlockType* getFFTData() { return fftDataFifo.acquire(); }
 
 private:
-    FFTOrder order;
+    FFTOrder order = FFTOrder::order2048;
     BlockType fftData;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    FFTResourceCache::Handle resources;
 
-    Fifo<BlockType> fftDataFifo;
+    // latest wins: only the newest spectrum is drawn
+    Fifo<BlockType, 30, FifoOverflow::OverwriteOldest> fftDataFifo;
 };
 
-template<typename PathType>
-struct AnalyzerPathGenerator
+enum class BinReduction
+{
+    Max,    // loudest bin wins, keeps narrow peaks visible
+    Mean    // average of the bins, smoother at high frequencies
+};
+
+/*
+ maps the FFT bins onto 'numPoints' log-spaced points between 20 Hz and 20 kHz.
+ built once per (fftSize, binWidth, numPoints); dense points reduce their bins,
+ sparse points interpolate between the two nearest bins.
+ */
+struct LogFrequencyBinMap
+{
+    bool matches(int fftSize, float binWidth, int numPoints) const
+    {
+        return fftSize == cachedFFTSize && binWidth == cachedBinWidth && numPoints == (int)points.size();
+    }
+
+    void build(int fftSize, float binWidth, int numPoints)
+    {
+        const int numBins = fftSize / 2;
+
+        points.resize(numPoints);
+
+        auto pointToFreq = [numPoints](float x)
+        {
+            return juce::mapToLog10(x / float(numPoints), 20.f, 20000.f);
+        };
+
+        for (int x = 0; x < numPoints; ++x)
+        {
+            auto& point = points[x];
+
+            auto lowBin = juce::jlimit(0, numBins, (int)std::ceil(pointToFreq(float(x)) / binWidth));
+            auto highBin = juce::jlimit(0, numBins, (int)std::ceil(pointToFreq(float(x + 1)) / binWidth));
+
+            if (highBin > lowBin)
+            {
+                point.firstBin = lowBin;
+                point.numBins = highBin - lowBin;
+                point.fraction = 0.f;
+            }
+            else
+            {
+                auto binPos = pointToFreq(float(x) + 0.5f) / binWidth;
+                auto bin = juce::jlimit(0, numBins - 2, (int)std::floor(binPos));
+
+                point.firstBin = bin;
+                point.numBins = 0;
+                point.fraction = juce::jlimit(0.f, 1.f, binPos - float(bin));
+            }
+        }
+
+        cachedFFTSize = fftSize;
+        cachedBinWidth = binWidth;
+    }
+
+    int getNumPoints() const { return (int)points.size(); }
+
+    float getValue(const std::vector<float>& renderData, int index, BinReduction reduction) const
+    {
+        const auto& point = points[index];
+        const auto* bins = renderData.data() + point.firstBin;
+
+        if (point.numBins == 0)
+            return bins[0] + point.fraction * (bins[1] - bins[0]);
+
+        if (reduction == BinReduction::Max)
+        {
+            auto v = bins[0];
+            for (int i = 1; i < point.numBins; ++i)
+                v = juce::jmax(v, bins[i]);
+
+            return v;
+        }
+
+        auto sum = 0.f;
+        for (int i = 0; i < point.numBins; ++i)
+            sum += bins[i];
+
+        return sum / float(point.numBins);
+    }
+
+private:
+    /*
+     the bins that fall into one point.
+     numBins > 0: dense point, reduce bins [firstBin, firstBin + numBins)
+     numBins == 0: sparse point, interpolate between firstBin and firstBin + 1
+     */
+    struct PointBins
+    {
+        int firstBin = 0;
+        int numBins = 0;
+        float fraction = 0.f;
+    };
+
+    std::vector<PointBins> points;
+    int cachedFFTSize = 0;
+    float cachedBinWidth = 0.f;
+};
+
+struct AnalyzerRenderDataGenerator
 {
     /*
-     converts 'renderData[]' into a juce::Path
+     converts 'renderData[]' into one y-value per pixel column,
+     written straight into the next free render buffer
      */
-    void generatePath(const std::vector<float>& renderData,
+    void generateRenderData(const std::vector<float>& renderData,
         juce::Rectangle<float> fftBounds,
         int fftSize,
         float binWidth,
@@ -110,12 +218,18 @@ struct AnalyzerPathGenerator
     {
         auto top = fftBounds.getY();
         auto bottom = fftBounds.getHeight();
-        auto width = fftBounds.getWidth();
+        auto numColumns = juce::jmax(1, (int)fftBounds.getWidth());
 
         int numBins = (int)fftSize / 2;
 
-        PathType p;
-        p.preallocateSpace(3 * (int)fftBounds.getWidth());
+        if (numBins < 2)
+            return;
+
+        if (!columnMap.matches(fftSize, binWidth, numColumns))
+        {
+            columnMap.build(fftSize, binWidth, numColumns);
+            renderBuffers.prepare(numColumns, bottom);
+        }
 
         auto map = [bottom, top, negativeInfinity](float v)
         {
@@ -124,43 +238,110 @@ struct AnalyzerPathGenerator
                 float(bottom + 10), top);
         };
 
-        auto y = map(renderData[0]);
+        auto* ys = renderBuffers.getWriteBuffer().data();
 
-        if (std::isnan(y) || std::isinf(y))
-            y = bottom;
+        for (int x = 0; x < numColumns; ++x)
+        {
+            auto y = map(columnMap.getValue(renderData, x, reduction));
 
-        p.startNewSubPath(0, y);
+            if (std::isnan(y) || std::isinf(y))
+                y = bottom;
 
-        const int pathResolution = 2; //you can draw line-to's every 'pathResolution' pixels.
+            ys[x] = y;
+        }
 
-        for (int binNum = 1; binNum < numBins; binNum += pathResolution)
-        {
-            y = map(renderData[binNum]);
+        renderBuffers.publish();
+    }
 
-            if (!std::isnan(y) && !std::isinf(y))
-            {
-                auto binFreq = binNum * binWidth;
-                auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
-                int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX, y);
-            }
-        }
+    void setBinReduction(BinReduction newReduction) { reduction = newReduction; }
+
+    bool hasNewRenderData() const { return renderBuffers.hasNewData(); }
+
+    // y-value per pixel column, relative to the fftBounds origin. stays valid until the next call.
+    const std::vector<float>& getRenderData() { return renderBuffers.acquire(); }
+
+private:
+    LogFrequencyBinMap columnMap;
+
+    BinReduction reduction = BinReduction::Max;
+
+    TripleBuffer<std::vector<float>> renderBuffers;
+};
+
+/*
+ running paint-time statistics, so layer/caching changes can be measured per frame.
+ */
+struct PaintTimingStats
+{
+    void addSample(juce::int64 startTicks)
+    {
+        auto ms = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
 
-        pathFifo.push(p);
+        totalMs += ms;
+        maxMs = juce::jmax(maxMs, ms);
+        ++numFrames;
     }
 
-    int getNumPathsAvailable() const
+    double getAverageMs() const { return numFrames > 0 ? totalMs / numFrames : 0.0; }
+    double getMaxMs() const { return maxMs; }
+    int getNumFrames() const { return numFrames; }
+
+    void reset()
     {
-        return pathFifo.getNumAvailableForReading();
+        totalMs = 0.0;
+        maxMs = 0.0;
+        numFrames = 0;
     }
 
-    bool getPath(PathType& path)
+private:
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+    int numFrames = 0;
+};
+
+/*
+ time from the start of the editor's construction to the end of its first
+ complete paint, written once to juce::Logger (so release builds report it too,
+ to the host's log or the debugger) against a budget.
+ */
+struct EditorOpenTiming
+{
+    // a target, three frames at 60 Hz, not a measurement: check the logged figures against it
+    static constexpr double budgetMs = 50.0;
+
+    void constructionFinished() { constructionMs = getMsSinceStart(); }
+
+    void firstPaintFinished()
     {
-        return pathFifo.pull(path);
+        if (painted)
+            return;
+
+        painted = true;
+        firstPaintMs = getMsSinceStart();
+
+        juce::Logger::writeToLog("SpectrumEQ editor open: constructed in " + juce::String(constructionMs, 1)
+                                 + " ms, first paint after " + juce::String(firstPaintMs, 1) + " ms (budget "
+                                 + juce::String(budgetMs, 0) + " ms" + (firstPaintMs > budgetMs ? ", OVER BUDGET)" : ")"));
+
+        // the editor took longer to open than the budget allows: see the log line above
+        jassert(firstPaintMs <= budgetMs);
     }
 
+    bool hasPainted() const { return painted; }
+
+    // 0 until they have happened
+    double getConstructionMs() const { return constructionMs; }
+    double getFirstPaintMs() const { return firstPaintMs; }
+
 private:
-    Fifo<PathType> pathFifo;
+    const juce::int64 startTicks = juce::Time::getHighResolutionTicks();
+    double constructionMs = 0.0, firstPaintMs = 0.0;
+    bool painted = false;
+
+    double getMsSinceStart() const
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    }
 };
 
 struct LookAndFeel : juce::LookAndFeel_V4
@@ -186,7 +367,12 @@ struct RotarySliderWithLabels : juce::Slider
         param(&rap),
         suffix(unitSuffix)
     {
-        setLookAndFeel(&lnf);
+        setLookAndFeel(&lnf.get());
+    }
+
+    RotarySliderWithLabels(juce::AudioProcessorValueTreeState& apvts, ParameterIndex index) :
+        RotarySliderWithLabels(*apvts.getParameter(parameterTable[index].id), parameterTable[index].unit)
+    {
     }
 
     ~RotarySliderWithLabels()
@@ -203,12 +389,23 @@ struct RotarySliderWithLabels : juce::Slider
     juce::Array<LabelPos> labels;
 
     void paint(juce::Graphics& g) override;
+    void resized() override;
     juce::Rectangle<int> getSliderBounds() const;
     int getTextHeight() const { return 14; }
     juce::String getDisplayString() const;
 
+    static float getStartAngle() { return juce::degreesToRadians(180.f + 45.f); }
+    static float getEndAngle() { return juce::degreesToRadians(180.f - 45.f) + juce::MathConstants<float>::twoPi; }
+
 private:
-    LookAndFeel lnf;
+    // one instance for every slider and the editor, instead of one per slider
+    juce::SharedResourcePointer<LookAndFeel> lnf;
+
+    // the min/max labels never change, so they are rendered once per size/scale
+    juce::Image labelLayer;
+    float labelLayerScale = 0.f;
+
+    void rebuildLabelLayer(float scale);
 
     juce::RangedAudioParameter* param;
     juce::String suffix;
@@ -218,11 +415,38 @@ struct PathProducer
 {
     PathProducer(SingleChannelSampleFifo<SpectrumEQAudioProcessor::BlockType>& scsf) : leftChannelFifo(&scsf)
     {
-        leftChannelFFTDataGenerator.changeOrder(FFTOrder::order2048);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
     }
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
-    juce::Path getPath() { return leftChannelFFTPath; };
+
+    // the FFT and buffers are only set up by the first process() call, i.e. once the analyzer or spectrogram
+    // is shown. the analyzer path is only rebuilt when renderPath is set
+    void process(juce::Rectangle<float> fftBounds, double sampleRate, bool renderPath = true);
+
+    // switches to MultiResolutionAnalyzer's stitched spectrum from the next process() call
+    void setMultiResolution(bool shouldUseMultiResolution, MultiResolutionAnalyzer::Normalisation normalisation)
+    {
+        multiResolution = shouldUseMultiResolution;
+        multiResolutionAnalyzer.setNormalisation(normalisation);
+    }
+    const std::vector<float>& getRenderData() { return renderDataGenerator.getRenderData(); }
+
+    // the newest dB spectrum
+    const std::vector<float>& getLatestSpectrum() const { return latestFFTData; }
+
+    // every spectrum the last process() call drained, oldest first, for consumers that want each frame.
+    // indices past the last one give the newest
+    int getNumNewSpectra() const { return numNewSpectra; }
+    const std::vector<float>& getNewSpectrum(int index) const
+    {
+        return index < numNewSpectra ? newSpectra[(size_t)index] : latestFFTData;
+    }
+    int getFFTSize() const
+    {
+        return preparedMultiResolution ? multiResolutionAnalyzer.getFFTSize() : leftChannelFFTDataGenerator.getFFTSize();
+    }
+
+    bool hasNewAudio() const { return leftChannelFifo->getNumCompleteBuffersAvailable() > 0; }
+    // true when the last spectrum was entirely at the display floor
+    bool isSilent() const { return lastFrameWasSilent; }
 
 private:
     SingleChannelSampleFifo<SpectrumEQAudioProcessor::BlockType>* leftChannelFifo;
@@ -230,16 +454,134 @@ private:
     juce::AudioBuffer<float> monoBuffer;
 
     FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
+    std::vector<float> latestFFTData;
+
+    // storage is kept between calls; at most one fifo's worth of spectra can arrive per call
+    std::vector<std::vector<float>> newSpectra;
+    int numNewSpectra = 0;
+
+    MultiResolutionAnalyzer multiResolutionAnalyzer;
+    bool multiResolution = false, preparedMultiResolution = false;
+
+    AnalyzerRenderDataGenerator renderDataGenerator;
 
-    AnalyzerPathGenerator<juce::Path> pathProducer;
+    bool lastFrameWasSilent = true;
 
-    juce::Path leftChannelFFTPath;
+    bool isPrepared() const { return monoBuffer.getNumSamples() > 0 && preparedMultiResolution == multiResolution; }
+    void prepare();
+};
+
+/*
+ scrolling time/frequency view. every analyzer frame writes one column into a
+ ring image through a colour LUT, and paint() blits the ring in two parts around
+ the write position, so the cost doesn't depend on the amount of history shown.
+ */
+struct SpectrogramComponent : juce::Component
+{
+    SpectrogramComponent();
+
+    void pushSpectra(const std::vector<float>& leftSpectrum,
+                     const std::vector<float>& rightSpectrum,
+                     int fftSize,
+                     float binWidth,
+                     float negativeInfinity);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+    void visibilityChanged() override;
+
+private:
+    // only allocated while the spectrogram is visible
+    juce::Image history;
+    int writeColumn = 0;
+
+    LogFrequencyBinMap rowMap;
+
+    static constexpr int lutSize = 256;
+    std::array<juce::PixelARGB, lutSize> colourLut;
+    bool lutBuilt = false;
+
+    void buildColourLut();
+};
+
+/*
+ input and output bars: RMS filled, the falling peak as a line, the peak hold as a
+ tick and a clip light per channel that stays on until clicked. ballistics run here,
+ on the message thread, from whatever the processor published since the last vblank.
+ */
+struct LevelMeterComponent : juce::Component
+{
+    LevelMeterComponent(SpectrumEQAudioProcessor& p);
+
+    void paint(juce::Graphics& g) override;
+    void mouseDown(const juce::MouseEvent& e) override;
+
+private:
+    static constexpr float minDb = -60.f;
+    static constexpr float maxDb = 6.f;
+
+    SpectrumEQAudioProcessor& audioProcessor;
+
+    LevelMeterSource::Reader reader;
+    LevelMeterBallistics ballistics;
+
+    void onVBlank();
+
+    juce::VBlankAttachment vBlankAttachment{ this, [this] { onVBlank(); } };
+};
+
+/*
+ caches the dB response of every band on a log-frequency grid (one point per
+ pixel column), so a parameter change only re-evaluates the band it belongs to.
+ */
+struct BandResponseCache
+{
+    static constexpr int numBands = numPanelBands;
+    static constexpr juce::uint32 allBands = (1u << numBands) - 1;
+
+    void prepare(int numPoints, double sampleRate);
+
+    /*
+     evaluates the cascade of 'sections' on the grid and stores it as 'band's response.
+     numSections == 0 means the band is bypassed (flat 0 dB).
+     */
+    void setBandSections(int band, const BiquadBank::Section* sections, int numSections);
+    void sumBands();
+
+    /*
+     phase and group delay are only evaluated while this is on; bands set while it
+     was off have to be set again once it is turned on.
+     */
+    void setComputesPhase(bool shouldCompute) { computePhase = shouldCompute; }
+    bool computesPhase() const { return computePhase; }
+
+    int getNumPoints() const { return (int)cosW.size(); }
+    double getSampleRate() const { return sampleRate; }
+    const std::vector<double>& getTotalDecibels() const { return totalDecibels; }
+
+    // radians wrapped to [-pi, pi], and seconds. only valid while computesPhase()
+    const std::vector<double>& getTotalPhase() const { return totalPhase; }
+    const std::vector<double>& getTotalGroupDelay() const { return totalGroupDelay; }
+
+private:
+    double sampleRate = 0.0;
+    bool computePhase = false;
+
+    // e^{-jw} and e^{-2jw} for every grid point
+    std::vector<double> cosW, sinW, cos2W, sin2W;
+
+    std::vector<double> power;
+    std::array<std::vector<double>, numBands> bandDecibels;
+    std::vector<double> totalDecibels;
+
+    // phase in radians (unwrapped sum of the sections'), group delay in samples
+    std::array<std::vector<double>, numBands> bandPhase, bandGroupDelay;
+    std::vector<double> totalPhase, totalGroupDelay;
 };
 
 struct ResponseCurveComponent : 
     juce::Component,
-    juce::AudioProcessorParameter::Listener,
-    juce::Timer
+    juce::AudioProcessorParameter::Listener
 {
     ResponseCurveComponent(SpectrumEQAudioProcessor&);
     ~ResponseCurveComponent();
@@ -248,33 +590,149 @@ struct ResponseCurveComponent :
 
     void parameterGestureChanged(int parameterIndex, bool gestureIsStaring) override { }
 
-    virtual void timerCallback() override;
-
     void paint(juce::Graphics& g) override;
     void resized() override;
 
     void toggleAnalysisEnablement(bool enabled)
     {
         shouldShowFFTAnalysis = enabled;
+        needsRepaint = true;
+    }
+
+    /*
+     the analyzer curves are rasterised column by column into an image by default.
+     stroking them as paths is kept for comparison
+     */
+    void setAnalyzerRasterised(bool shouldRasterise)
+    {
+        rasteriseAnalyzer = shouldRasterise;
+        needsRepaint = true;
+    }
+
+    // a fading fill under each analyzer curve. only drawn while they are rasterised
+    void setAnalyzerFilled(bool shouldFill)
+    {
+        fillAnalyzer = shouldFill;
+        needsRepaint = true;
+    }
+
+    /*
+     refresh rate cap for this instance. the analyzer drops to 'idleHz'
+     while its input is silent, and nothing is repainted while there is no new work.
+     */
+    void setRefreshRates(double maxHz, double idleHz)
+    {
+        maxRefreshRateHz = juce::jmax(1.0, maxHz);
+        idleRefreshRateHz = juce::jlimit(1.0, maxRefreshRateHz, idleHz);
+    }
+
+    // the spectrogram is fed from our analyzer while it is showing, whether or not the analyzer curve is
+    void setSpectrogram(SpectrogramComponent* newSpectrogram) { spectrogram = newSpectrogram; }
+
+    // overlays of the curve's phase and group delay, only computed while one of them is shown
+    void setOverlays(bool showPhase, bool showGroupDelay);
+
+    /*
+     paints into an offscreen software image numFrames times at 'scale', with whatever the
+     analyzer and curves currently show: first the way paint() worked before its static
+     layers were cached (grid, labels and border drawn every frame, the whole component
+     repainted), then the way it works now (layers blitted, clipped to the analysis area
+     the timer repaints). averages per frame, not counting one warm-up frame each
+     */
+    struct PaintMeasurement
+    {
+        int numFrames = 0;
+        float scale = 1.f;
+        double uncachedMs = 0.0, cachedMs = 0.0;
+    };
+
+    PaintMeasurement measurePaint(int numFrames, float scale);
+
+    // long FFT resolution for the low octaves, with the levels normalised for tones or for noise, see MultiResolutionAnalyzer
+    void setAnalyzerMultiResolution(bool shouldUseMultiResolution, MultiResolutionAnalyzer::Normalisation normalisation)
+    {
+        leftPathProducer.setMultiResolution(shouldUseMultiResolution, normalisation);
+        rightPathProducer.setMultiResolution(shouldUseMultiResolution, normalisation);
+        needsRepaint = true;
     }
 
 private:
     SpectrumEQAudioProcessor& audioProcessor;
 
     bool shouldShowFFTAnalysis = true;
+    bool needsRepaint = true;
+
+    bool shouldShowPhase = false, shouldShowGroupDelay = false;
+    bool overlaysStale = false;
+
+    SpectrogramComponent* spectrogram = nullptr;
+
+    bool isFeedingSpectrogram() const { return spectrogram != nullptr && spectrogram->isShowing(); }
 
-    juce::Atomic<bool> parametersChanged{ false };
+    double maxRefreshRateHz = 60.0;
+    double idleRefreshRateHz = 10.0;
+    double lastRefreshMs = 0.0;
+    bool analyzerIsIdle = false;
 
-    MonoChain monoChain;
+    void onVBlank();
+    void refresh();
+
+    std::atomic<juce::uint32> dirtyBands{ BandResponseCache::allBands };
+    std::vector<juce::uint32> bandMaskForParameter;
+
+    // deferred to the first vblank we are showing for, rather than done while the editor opens
+    bool listeningToParameters = false;
+    void startListeningToParameters();
+
+    // every band's sections as BiquadBank designs them; none while it's bypassed
+    std::array<std::array<BiquadBank::Section, BiquadBank::maxSectionsPerBand>, numPanelBands> bandSections{};
+    std::array<int, numPanelBands> numBandSections{};
+
+    // what they were designed from
+    std::array<BandSpec, numPanelBands> designedBands;
+    std::array<bool, numPanelBands> designedBypassed{};
+
+    BandResponseCache responseCache;
 
     void updateResponseCurve();
+    void updateBandResponse(int band);
 
     juce::Path responseCurve;
+    juce::Path phaseCurve, groupDelayCurve;
+    double groupDelayScaleMs = 1.0;
+
+    void buildOverlayCurves(juce::Rectangle<int> responseArea);
 
-    void updateChain();
+    void updateBandSections(juce::uint32 bands);
+
+    // the bands whose parameters no longer match what they were designed from
+    juce::uint32 getOutdatedBands() const;
 
     void drawBackgroundGrid(juce::Graphics& g);
     void drawTextLabels(juce::Graphics& g);
+    void drawBorder(juce::Graphics& g);
+
+    // static layers, rebuilt only on resized() or when the display scale changes
+    juce::Image backgroundLayer, foregroundLayer;
+    float layerScale = 0.f;
+
+    // draws what the layers hold on every paint instead, for measurePaint()
+    bool drawLayersDirectly = false;
+
+    void rebuildLayers(float scale);
+
+    // reused every frame, Path::clear() keeps the allocated storage
+    juce::Path leftAnalyzerPath, rightAnalyzerPath;
+
+    bool rasteriseAnalyzer = true;
+    bool fillAnalyzer = false;
+    SpectrumRasteriser analyzerRasteriser;
+
+    void buildAnalyzerPath(juce::Path& p, const std::vector<float>& ys, juce::Rectangle<int> area);
+
+   #if SPECTRUMEQ_DEBUG_STATS
+    PaintTimingStats paintTiming;
+   #endif
 
     std::vector<float> getFrequencies();
     std::vector<float> getGains();
@@ -285,6 +743,9 @@ private:
     juce::Rectangle<int> getAnalysisArea();
 
     PathProducer leftPathProducer, rightPathProducer;
+
+    // declared last, so it is detached before anything its callback touches is destroyed
+    juce::VBlankAttachment vBlankAttachment{ this, [this] { onVBlank(); } };
 };
 
 //==============================================================================
@@ -292,14 +753,21 @@ struct PowerButton : juce::ToggleButton {};
 
 struct AnalyzerButton : juce::ToggleButton
 {
-    void resized() override
+    // built on first paint for the current size, from a fixed seed so it doesn't change between opens
+    const juce::Path& getRandomPath()
     {
         auto bounds = getLocalBounds();
+
+        if (bounds == randomPathBounds)
+            return randomPath;
+
+        randomPathBounds = bounds;
+
         auto insetRect = bounds.reduced(4);
 
         randomPath.clear();
 
-        juce::Random r;
+        juce::Random r(0x5eed);
 
         randomPath.startNewSubPath(insetRect.getX(),
             insetRect.getY() + insetRect.getHeight() * r.nextFloat());
@@ -308,13 +776,18 @@ struct AnalyzerButton : juce::ToggleButton
         {
             randomPath.lineTo(x, insetRect.getY() + insetRect.getHeight() * r.nextFloat());
         }
+
+        return randomPath;
     }
 
+private:
     juce::Path randomPath;
+    juce::Rectangle<int> randomPathBounds;
 };
 /**
 */
-class SpectrumEQAudioProcessorEditor  : public juce::AudioProcessorEditor
+class SpectrumEQAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                        private juce::ChangeListener
 {
 public:
     SpectrumEQAudioProcessorEditor (SpectrumEQAudioProcessor&);
@@ -322,13 +795,23 @@ public:
 
     //==============================================================================
     void paint (juce::Graphics&) override;
+    void paintOverChildren(juce::Graphics&) override;
     void resized() override;
 
+    /*
+     Ctrl/Cmd+Shift+P logs measurePaint() at 1x and 2x and FFTResourceCache's stats through juce::Logger.
+     with SPECTRUMEQ_TRACE, Ctrl/Cmd+Shift+T writes the trace recorded so far to the desktop
+     */
+    bool keyPressed(const juce::KeyPress& key) override;
+
 private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     SpectrumEQAudioProcessor& audioProcessor;
 
+    // before the controls, so their construction is part of the measurement
+    EditorOpenTiming openTiming;
+
     RotarySliderWithLabels lowPeakFreqSlider, 
                            lowPeakGainSlider, 
                            lowPeakQualitySlider,
@@ -352,45 +835,52 @@ private:
 
     std::vector<juce::Component*> getComps();
 
+    SpectrogramComponent spectrogramComponent;
     ResponseCurveComponent responseCurveComponent;
+    LevelMeterComponent levelMeterComponent;
 
     using APVTS = juce::AudioProcessorValueTreeState;
     using Attachment = APVTS::SliderAttachment;
+    using ButtonAttachment = APVTS::ButtonAttachment;
+    using ComboBoxAttachment = APVTS::ComboBoxAttachment;
 
-    Attachment lowPeakFreqSliderAttachment,
-               lowPeakGainSliderAttachment,
-               lowPeakQualitySliderAttachment,
+    PowerButton lowcutBypassButton, lowPeakBypassButton, lowMidPeakBypassButton, highMidPeakBypassButton, highPeakBypassButton, highcutBypassButton; 
+    AnalyzerButton analyzerEnabledButton;
+    juce::ToggleButton spectrogramEnabledButton{ "Spectrogram" };
+    juce::ToggleButton phaseButton{ "Phase" }, groupDelayButton{ "Group Delay" };
+    // single FFT, or multi-resolution with tones or noise reading true
+    juce::ComboBox analyzerResolutionBox;
+    juce::ToggleButton analyzerFillButton{ "Fill" };
+    juce::ToggleButton autoGainButton{ "Auto Gain" }, autoGainFreezeButton{ "Freeze" };
 
-               lowMidPeakFreqSliderAttachment,
-               lowMidPeakGainSliderAttachment,
-               lowMidPeakQualitySliderAttachment,
+    // picking a stored slot recalls it; Store saves the current settings into the picked slot
+    juce::ComboBox presetSlotBox;
+    juce::TextButton storePresetButton{ "Store" };
+    void refreshPresetSlots();
 
-               highMidPeakFreqSliderAttachment,
-               highMidPeakGainSliderAttachment,
-               highMidPeakQualitySliderAttachment,
+    // the processor's presetChanges, e.g. the host picking a program
+    void changeListenerCallback(juce::ChangeBroadcaster*) override { refreshPresetSlots(); }
 
-               highPeakFreqSliderAttachment,
-               highPeakGainSliderAttachment,
-               highPeakQualitySliderAttachment,
+    juce::ComboBox lowCutRoutingBox, lowPeakRoutingBox, lowMidPeakRoutingBox, highMidPeakRoutingBox, highPeakRoutingBox, highCutRoutingBox;
 
-               lowCutFreqSliderAttachment,
-               highCutFreqSliderAttachment,
-               lowCutSlopeSliderAttachment,
-               highCutSlopeSliderAttachment;
+    // the peak bands' dynamics, as bars under each band's knobs that carry their own label in the value text
+    juce::Slider lowPeakThresholdSlider, lowPeakRatioSlider, lowPeakAttackSlider, lowPeakReleaseSlider,
+                 lowMidPeakThresholdSlider, lowMidPeakRatioSlider, lowMidPeakAttackSlider, lowMidPeakReleaseSlider,
+                 highMidPeakThresholdSlider, highMidPeakRatioSlider, highMidPeakAttackSlider, highMidPeakReleaseSlider,
+                 highPeakThresholdSlider, highPeakRatioSlider, highPeakAttackSlider, highPeakReleaseSlider;
 
-    PowerButton lowcutBypassButton, lowPeakBypassButton, lowMidPeakBypassButton, highMidPeakBypassButton, highPeakBypassButton, highcutBypassButton; 
-    AnalyzerButton analyzerEnabledButton;
+    // threshold, ratio, attack and release of DynamicPeakBands' band peakBand
+    std::array<juce::Slider*, 4> getDynamicsSliders(int peakBand);
+    void setupDynamicsSliders();
 
-    using ButtonAttachment = APVTS::ButtonAttachment;
-    ButtonAttachment lowcutBypassButtonAttachment, 
-                     lowPeakBypassButtonAttachment,
-                     lowMidPeakBypassButtonAttachment,
-                     highMidPeakBypassButtonAttachment,
-                     highPeakBypassButtonAttachment,
-                     highcutBypassButtonAttachment,
-                     analyzerEnabledButtonAttachment;
-
-    LookAndFeel lnf;
+    // generated from parameterTable, declared after the controls so they are destroyed first
+    std::vector<std::unique_ptr<Attachment>> sliderAttachments;
+    std::vector<std::unique_ptr<ButtonAttachment>> buttonAttachments;
+    std::vector<std::unique_ptr<ComboBoxAttachment>> comboBoxAttachments;
+
+    juce::Component* getComponentForParameter(ParameterIndex index);
+
+    juce::SharedResourcePointer<LookAndFeel> lnf;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumEQAudioProcessorEditor)
 };
@@ -68,22 +68,26 @@ double SpectrumEQAudioProcessor::getTailLengthSeconds() const
 
 int SpectrumEQAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    // the filled preset bank slots are exposed to the host as programs. hosts want at least one
+    return juce::jmax(1, presetBank.getNumFilledSlots());
 }
 
 int SpectrumEQAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return juce::jmax(0, presetBank.getFilledIndex(currentSlot));
 }
 
 void SpectrumEQAudioProcessor::setCurrentProgram (int index)
 {
+    recallPreset(presetBank.getFilledSlot(index));
 }
 
 const juce::String SpectrumEQAudioProcessor::getProgramName (int index)
 {
-    return {};
+    if (auto* entry = presetBank.getEntry(presetBank.getFilledSlot(index)))
+        return entry->name;
+
+    return "Default";
 }
 
 void SpectrumEQAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -96,18 +100,30 @@ void SpectrumEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerB
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+    filterEngine.prepare(sampleRate);
+
+    // where the session starts and where a fresh band starts are where automation will be moving first
+    {
+        const auto current = makePanelBands(getChainSettings(parameterHandles));
+        const auto defaults = makeDefaultPanelBands();
+
+        std::vector<BandSpec> centres(current.begin(), current.end());
+        centres.insert(centres.end(), defaults.begin(), defaults.end());
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+        filterEngine.prewarm(centres);
+    }
+
+    autoGain.prepare(sampleRate, samplesPerBlock);
 
-    updateFilters();
+    filterEngine.update(getChainSettings(parameterHandles));
 
     leftChannelFifo.prepare(samplesPerBlock);
     rightChannelFifo.prepare(samplesPerBlock);
+
+    if (frameExportTap != nullptr)
+        frameExportTap->prepare(sampleRate);
+
+    levelMeters.reset();
 }
 
 void SpectrumEQAudioProcessor::releaseResources()
@@ -144,6 +160,8 @@ bool SpectrumEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layout
 
 void SpectrumEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    SPECTRUMEQ_TRACE_SCOPE("processBlock");
+
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -157,21 +175,71 @@ void SpectrumEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, j
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateFilters();
+    measureBlockLevels(buffer, MeterChannel::InputLeft);
+
+    // a recalled preset switches all coefficients at once, at the start of this block
+    if (auto* preset = pendingPresetRecall.exchange(nullptr))
+    {
+        if (auto* coefficients = preset->findCoefficients(getSampleRate()))
+            filterEngine.recall(*coefficients);
+    }
 
-    juce::dsp::AudioBlock<float> block(buffer);
-    
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    // nothing below touches the entry, so from here on the preset bank may free it
+    blocksCompleted.fetch_add(1);
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    // while the message thread is rewriting parameters in bulk, or started doing so while
+    // we were reading them, keep the coefficients we already have instead of a half-updated set
+    auto sequence = parameterWriteSequence.load();
+    if ((sequence & 1) == 0)
+    {
+        auto chainSettings = getChainSettings(parameterHandles);
+
+        if (parameterWriteSequence.load() == sequence)
+            filterEngine.update(chainSettings);
+    }
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    const auto autoGainEnabled = parameterHandles.getBool(AutoGainEnabled);
+
+    // switching it on meters from scratch; switching it off lets fadeOut() ramp the gain back instead of jumping
+    if (autoGainEnabled != autoGainWasEnabled)
+    {
+        if (autoGainEnabled)
+            autoGain.resetMeasurement();
+
+        autoGainWasEnabled = autoGainEnabled;
+    }
+
+    if (autoGainEnabled)
+        autoGain.captureInput(buffer);
+
+    filterEngine.process(juce::dsp::AudioBlock<float>(buffer));
+
+    if (autoGainEnabled)
+        autoGain.process(buffer, parameterHandles.getBool(AutoGainFreeze));
+    else
+        autoGain.fadeOut(buffer);
+
+    // measured right before the analyzer copies the same samples
+    measureBlockLevels(buffer, MeterChannel::OutputLeft);
+    levelMeters.publish(blockLevels, buffer.getNumSamples());
 
     leftChannelFifo.update(buffer);
     rightChannelFifo.update(buffer);
+
+    if (frameExportTap != nullptr)
+        frameExportTap->push(buffer);
+}
+
+void SpectrumEQAudioProcessor::measureBlockLevels(const juce::AudioBuffer<float>& buffer, int firstMeter)
+{
+    // buffer channel 0 is left; a mono buffer shows on both meters
+    const auto numChannels = buffer.getNumChannels();
+
+    for (int side = 0; side < 2; ++side)
+    {
+        const auto channel = juce::jmin(side, numChannels - 1);
+        blockLevels[(size_t)(firstMeter + side)] = measureLevels(buffer.getReadPointer(channel), buffer.getNumSamples());
+    }
 }
 
 //==============================================================================
@@ -193,253 +261,349 @@ void SpectrumEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
 
-    juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    PresetBank::writeState(*this, destData);
 }
 
 void SpectrumEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
+    std::vector<float> values;
+    if (PresetBank::readState(data, sizeInBytes, *this, values))
+    {
+        applyParameterValues(values, nullptr);
+        return;
+    }
+
+    // sessions saved before the binary format hold the whole ValueTree
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if (tree.isValid())
     {
+        parameterWriteSequence.fetch_add(1);
         apvts.replaceState(tree);
-        updateFilters();
+        parameterWriteSequence.fetch_add(1);
+    }
+}
+
+void SpectrumEQAudioProcessor::storePreset(int slot)
+{
+    presetBank.store(slot, *this, getChainSettings(parameterHandles), getSampleRate());
+    currentSlot = slot;
+
+    freeReplacedPresets();
+
+    // a new slot adds a program
+    updateHostDisplay(ChangeDetails().withProgramChanged(true));
+    presetChanges.sendChangeMessage();
+}
+
+void SpectrumEQAudioProcessor::recallPreset(int slot)
+{
+    if (auto* entry = presetBank.getEntry(slot))
+    {
+        currentSlot = slot;
+        applyParameterValues(entry->values, entry);
+
+        presetChanges.sendChangeMessage();
+    }
+
+    freeReplacedPresets();
+}
+
+void SpectrumEQAudioProcessor::freeReplacedPresets()
+{
+    // pending first, see PresetBank::freeReplacedEntries()
+    const auto* pending = pendingPresetRecall.load();
+    presetBank.freeReplacedEntries(pending, blocksCompleted.load());
+}
+
+void SpectrumEQAudioProcessor::applyParameterValues(const std::vector<float>& values, const PresetBank::Entry* preset)
+{
+    // odd sequence first, so the audio thread can't mix old and new values from here on
+    parameterWriteSequence.fetch_add(1);
+
+    if (preset != nullptr)
+        pendingPresetRecall.store(preset);
+
+    const auto& params = getParameters();
+    for (int i = 0; i < juce::jmin(params.size(), (int)values.size()); ++i)
+    {
+        if (params[i]->getValue() != values[i])
+            params[i]->setValueNotifyingHost(values[i]);
     }
+
+    parameterWriteSequence.fetch_add(1);
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) 
+ChainSettings getChainSettings(const ParameterHandles& handles)
 {
     ChainSettings settings;
       
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
+    settings.lowCutFreq = handles.get(LowCutFreq);
+    settings.highCutFreq = handles.get(HighCutFreq);
 
-    settings.lowPeakFreq = apvts.getRawParameterValue("Low Peak Freq")->load();
-    settings.lowPeakGainInDecibels = apvts.getRawParameterValue("Low Peak Gain")->load();
-    settings.lowPeakQuality = apvts.getRawParameterValue("Low Peak Quality")->load();
+    settings.lowPeakFreq = handles.get(LowPeakFreq);
+    settings.lowPeakGainInDecibels = handles.get(LowPeakGain);
+    settings.lowPeakQuality = handles.get(LowPeakQuality);
 
-    settings.lowMidPeakFreq = apvts.getRawParameterValue("LowMid Peak Freq")->load();
-    settings.lowMidPeakGainInDecibels = apvts.getRawParameterValue("LowMid Peak Gain")->load();
-    settings.lowMidPeakQuality = apvts.getRawParameterValue("LowMid Peak Quality")->load();
+    settings.lowMidPeakFreq = handles.get(LowMidPeakFreq);
+    settings.lowMidPeakGainInDecibels = handles.get(LowMidPeakGain);
+    settings.lowMidPeakQuality = handles.get(LowMidPeakQuality);
 
-    settings.highMidPeakFreq = apvts.getRawParameterValue("HighMid Peak Freq")->load();
-    settings.highMidPeakGainInDecibels = apvts.getRawParameterValue("HighMid Peak Gain")->load();
-    settings.highMidPeakQuality = apvts.getRawParameterValue("HighMid Peak Quality")->load();
+    settings.highMidPeakFreq = handles.get(HighMidPeakFreq);
+    settings.highMidPeakGainInDecibels = handles.get(HighMidPeakGain);
+    settings.highMidPeakQuality = handles.get(HighMidPeakQuality);
 
-    settings.highPeakFreq = apvts.getRawParameterValue("High Peak Freq")->load();
-    settings.highPeakGainInDecibels = apvts.getRawParameterValue("High Peak Gain")->load();
-    settings.highPeakQuality = apvts.getRawParameterValue("High Peak Quality")->load();
+    settings.highPeakFreq = handles.get(HighPeakFreq);
+    settings.highPeakGainInDecibels = handles.get(HighPeakGain);
+    settings.highPeakQuality = handles.get(HighPeakQuality);
 
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    settings.lowCutSlope = static_cast<Slope>(handles.get(LowCutSlope));
+    settings.highCutSlope = static_cast<Slope>(handles.get(HighCutSlope));
 
-    settings.lowCutBypassed = apvts.getRawParameterValue("LowCut Bypassed")->load() > 0.5f; // if > 0.5, bypassed
+    settings.lowCutBypassed = handles.getBool(LowCutBypassed); // if > 0.5, bypassed
 
-    settings.lowPeakBypassed = apvts.getRawParameterValue("Low Peak Bypassed")->load() > 0.5f;
-    settings.lowMidPeakBypassed = apvts.getRawParameterValue("LowMid Peak Bypassed")->load() > 0.5f;
-    settings.highMidPeakBypassed = apvts.getRawParameterValue("HighMid Peak Bypassed")->load() > 0.5f;
-    settings.highPeakBypassed = apvts.getRawParameterValue("High Peak Bypassed")->load() > 0.5f;
+    settings.lowPeakBypassed = handles.getBool(LowPeakBypassed);
+    settings.lowMidPeakBypassed = handles.getBool(LowMidPeakBypassed);
+    settings.highMidPeakBypassed = handles.getBool(HighMidPeakBypassed);
+    settings.highPeakBypassed = handles.getBool(HighPeakBypassed);
 
-    settings.highCutBypassed = apvts.getRawParameterValue("HighCut Bypassed")->load() > 0.5f;
+    settings.highCutBypassed = handles.getBool(HighCutBypassed);
+
+    auto getDynamics = [&handles](ParameterIndex threshold, ParameterIndex ratio, ParameterIndex attack, ParameterIndex release)
+    {
+        return PeakDynamics{ handles.get(threshold), handles.get(ratio), handles.get(attack), handles.get(release) };
+    };
+
+    settings.lowPeakDynamics = getDynamics(LowPeakThreshold, LowPeakRatio, LowPeakAttack, LowPeakRelease);
+    settings.lowMidPeakDynamics = getDynamics(LowMidPeakThreshold, LowMidPeakRatio, LowMidPeakAttack, LowMidPeakRelease);
+    settings.highMidPeakDynamics = getDynamics(HighMidPeakThreshold, HighMidPeakRatio, HighMidPeakAttack, HighMidPeakRelease);
+    settings.highPeakDynamics = getDynamics(HighPeakThreshold, HighPeakRatio, HighPeakAttack, HighPeakRelease);
+
+    settings.lowCutRouting = static_cast<BandRouting>(handles.get(LowCutRouting));
+    settings.lowPeakRouting = static_cast<BandRouting>(handles.get(LowPeakRouting));
+    settings.lowMidPeakRouting = static_cast<BandRouting>(handles.get(LowMidPeakRouting));
+    settings.highMidPeakRouting = static_cast<BandRouting>(handles.get(HighMidPeakRouting));
+    settings.highPeakRouting = static_cast<BandRouting>(handles.get(HighPeakRouting));
+    settings.highCutRouting = static_cast<BandRouting>(handles.get(HighCutRouting));
 
     return settings;
 }
 
-Coefficients makeLowPeakFilter(const ChainSettings& chainSettings, double sampleRate)
+std::array<BandSpec, numPanelBands> makeDefaultPanelBands()
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        chainSettings.lowPeakFreq,
-        chainSettings.lowPeakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.lowPeakGainInDecibels));
-}
+    auto bands = makePanelBands(ChainSettings());
 
-Coefficients makeLowMidPeakFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        chainSettings.lowMidPeakFreq,
-        chainSettings.lowMidPeakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.lowMidPeakGainInDecibels));
+    for (const auto& row : parameterTable)
+    {
+        if (row.band == noBand)
+            continue;
+
+        auto& spec = bands[(size_t)row.band];
+
+        switch (row.role)
+        {
+            case ParameterRole::Freq:    spec.freq = row.defaultValue; break;
+            case ParameterRole::Gain:    spec.gainInDecibels = row.defaultValue; break;
+            case ParameterRole::Quality: spec.quality = row.defaultValue; break;
+            case ParameterRole::Slope:   spec.order = 2 * ((int)row.defaultValue + 1); break;
+            default: break;
+        }
+    }
+
+    return bands;
 }
 
-Coefficients makeHighMidPeakFilter(const ChainSettings& chainSettings, double sampleRate)
+//==============================================================================
+juce::StringArray getRoutingChoices()
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        chainSettings.highMidPeakFreq,
-        chainSettings.highMidPeakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.highMidPeakGainInDecibels));
+    return { "Stereo", "Mid", "Side", "Left", "Right" };
 }
 
-Coefficients makeHighPeakFilter(const ChainSettings& chainSettings, double sampleRate)
+//==============================================================================
+const ChainCoefficients* PresetBank::Entry::findCoefficients(double sampleRate) const
 {
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        chainSettings.highPeakFreq,
-        chainSettings.highPeakQuality,
-        juce::Decibels::decibelsToGain(chainSettings.highPeakGainInDecibels));
+    for (const auto& coefficients : coefficientSets)
+    {
+        if (std::abs(coefficients.sampleRate - sampleRate) < 0.5)
+            return &coefficients;
+    }
+
+    return nullptr;
 }
 
-void SpectrumEQAudioProcessor::updateLowPeakFilter(const ChainSettings& chainSettings)
+void PresetBank::store(int slot, juce::AudioProcessor& processor, const ChainSettings& chainSettings, double currentSampleRate)
 {
-    auto peakCoefficients = makeLowPeakFilter(chainSettings, getSampleRate());
+    if (!juce::isPositiveAndBelow(slot, numSlots))
+    {
+        jassertfalse;
+        return;
+    }
 
-    leftChain.setBypassed<ChainPositions::LowPeak>(chainSettings.lowPeakBypassed);
-    rightChain.setBypassed<ChainPositions::LowPeak>(chainSettings.lowPeakBypassed);
+    auto entry = std::make_unique<Entry>();
+    entry->name = "Slot " + juce::String(slot + 1);
 
-    updateCoefficients(leftChain.get<ChainPositions::LowPeak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::LowPeak>().coefficients, peakCoefficients);
-}
+    for (auto* param : processor.getParameters())
+        entry->values.push_back(param->getValue());
 
-void SpectrumEQAudioProcessor::updateLowMidPeakFilter(const ChainSettings& chainSettings)
-{
-    auto peakCoefficients = makeLowMidPeakFilter(chainSettings, getSampleRate());
+    for (auto sampleRate : supportedSampleRates)
+        entry->coefficientSets.push_back(ChainCoefficients::design(chainSettings, sampleRate));
+
+    if (currentSampleRate > 0.0 && entry->findCoefficients(currentSampleRate) == nullptr)
+        entry->coefficientSets.push_back(ChainCoefficients::design(chainSettings, currentSampleRate));
 
-    leftChain.setBypassed<ChainPositions::LowMidPeak>(chainSettings.lowMidPeakBypassed);
-    rightChain.setBypassed<ChainPositions::LowMidPeak>(chainSettings.lowMidPeakBypassed);
+    // the audio thread may still be handed the old entry, so it is only freed by freeReplacedEntries()
+    if (slots[(size_t)slot] != nullptr)
+        replacedEntries.push_back({ std::move(slots[(size_t)slot]) });
 
-    updateCoefficients(leftChain.get<ChainPositions::LowMidPeak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::LowMidPeak>().coefficients, peakCoefficients);
+    slots[(size_t)slot] = std::move(entry);
 }
 
-void SpectrumEQAudioProcessor::updateHighMidPeakFilter(const ChainSettings& chainSettings)
+const PresetBank::Entry* PresetBank::getEntry(int slot) const
 {
-    auto peakCoefficients = makeHighMidPeakFilter(chainSettings, getSampleRate());
-
-    leftChain.setBypassed<ChainPositions::HighMidPeak>(chainSettings.highMidPeakBypassed);
-    rightChain.setBypassed<ChainPositions::HighMidPeak>(chainSettings.highMidPeakBypassed);
+    return juce::isPositiveAndBelow(slot, numSlots) ? slots[(size_t)slot].get() : nullptr;
+}
 
-    updateCoefficients(leftChain.get<ChainPositions::HighMidPeak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::HighMidPeak>().coefficients, peakCoefficients);
+int PresetBank::getNumFilledSlots() const
+{
+    return (int)std::count_if(slots.begin(), slots.end(), [](const auto& entry) { return entry != nullptr; });
 }
 
-void SpectrumEQAudioProcessor::updateHighPeakFilter(const ChainSettings& chainSettings)
+int PresetBank::getFilledSlot(int index) const
 {
-    auto peakCoefficients = makeHighPeakFilter(chainSettings, getSampleRate());
+    for (int slot = 0; slot < numSlots; ++slot)
+    {
+        if (slots[(size_t)slot] != nullptr && index-- == 0)
+            return slot;
+    }
 
-    leftChain.setBypassed<ChainPositions::HighPeak>(chainSettings.highPeakBypassed);
-    rightChain.setBypassed<ChainPositions::HighPeak>(chainSettings.highPeakBypassed);
+    return -1;
+}
 
-    updateCoefficients(leftChain.get<ChainPositions::HighPeak>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::HighPeak>().coefficients, peakCoefficients);
+int PresetBank::getFilledIndex(int slot) const
+{
+    if (getEntry(slot) == nullptr)
+        return -1;
+
+    return (int)std::count_if(slots.begin(), slots.begin() + slot, [](const auto& entry) { return entry != nullptr; });
 }
 
-void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+void PresetBank::freeReplacedEntries(const Entry* pending, juce::uint32 blocksCompleted)
 {
-    *old = *replacements;
+    for (auto it = replacedEntries.begin(); it != replacedEntries.end();)
+    {
+        if (!it->released)
+        {
+            // a block that took it before 'pending' was read bumps blocksCompleted after this
+            if (it->entry.get() != pending)
+            {
+                it->released = true;
+                it->blocksWhenReleased = blocksCompleted;
+            }
+
+            ++it;
+        }
+        else if (it->blocksWhenReleased != blocksCompleted)
+        {
+            it = replacedEntries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
 }
 
-void SpectrumEQAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings)
+void PresetBank::writeState(juce::AudioProcessor& processor, juce::MemoryBlock& destData)
 {
-    auto cutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+    const auto& params = processor.getParameters();
 
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+    juce::MemoryOutputStream mos(destData, false);
+    mos.writeInt((int)stateMagic);
+    mos.writeShort((short)stateVersion);
+    mos.writeShort((short)params.size());
 
-    updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    updateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
+    for (auto* param : params)
+    {
+        auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(param);
+        mos.writeString(withID != nullptr ? withID->paramID : juce::String());
+        mos.writeFloat(param->getValue());
+    }
 }
 
-void SpectrumEQAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+bool PresetBank::readState(const void* data, int sizeInBytes, juce::AudioProcessor& processor, std::vector<float>& values)
 {
-    auto cutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+    constexpr int headerSize = 8;
+    constexpr int hashedValueSize = 8;
 
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+    if (data == nullptr || sizeInBytes < headerSize)
+        return false;
 
-    updateCutFilter(leftHighCut, cutCoefficients, chainSettings.highCutSlope);
-    updateCutFilter(rightHighCut, cutCoefficients, chainSettings.highCutSlope);
-}
+    juce::MemoryInputStream mis(data, (size_t)sizeInBytes, false);
 
-void SpectrumEQAudioProcessor::updateFilters()
-{
-    auto chainSettings = getChainSettings(apvts);
+    if ((juce::uint32)mis.readInt() != stateMagic)
+        return false;
+
+    const auto version = (int)mis.readShort();
+
+    if (version != stateVersion && version != hashedStateVersion)
+        return false;
+
+    const int numValues = (juce::uint16)mis.readShort();
+
+    if (version == hashedStateVersion && sizeInBytes < headerSize + numValues * hashedValueSize)
+        return false;
+
+    const auto& params = processor.getParameters();
+
+    // anything missing from the state keeps its current value
+    values.clear();
+    for (auto* param : params)
+        values.push_back(param->getValue());
 
-    updateLowCutFilters(chainSettings);
-    updateLowPeakFilter(chainSettings);
-    updateLowMidPeakFilter(chainSettings);
-    updateHighMidPeakFilter(chainSettings);
-    updateHighPeakFilter(chainSettings);
-    updateHighCutFilters(chainSettings);
+    auto assign = [&params, &values](auto&& matchesID, float value)
+    {
+        for (int p = 0; p < params.size(); ++p)
+        {
+            auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(params[p]);
+
+            if (withID != nullptr && matchesID(withID->paramID))
+            {
+                values[(size_t)p] = value;
+                return;
+            }
+        }
+    };
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        if (version == hashedStateVersion)
+        {
+            const auto hash = mis.readInt();
+            const auto value = juce::jlimit(0.f, 1.f, mis.readFloat());
+
+            assign([hash](const juce::String& id) { return id.hashCode() == hash; }, value);
+            continue;
+        }
+
+        const auto id = mis.readString();
+
+        // a truncated state is rejected whole rather than half applied
+        if (mis.getNumBytesRemaining() < (juce::int64)sizeof(float))
+            return false;
+
+        const auto value = juce::jlimit(0.f, 1.f, mis.readFloat());
+
+        assign([&id](const juce::String& paramID) { return paramID == id; }, value);
+    }
+
+    return true;
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SpectrumEQAudioProcessor::createParameterLayout()
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq", 
-                                                           "LowCut Freq",
-                                                            juce::NormalisableRange<float>(20.f, 60.f, 1.f, 0.25f),
-                                                            20.f));
-    
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq",
-                                                           "HighCut Freq",
-                                                            juce::NormalisableRange<float>(8000.f, 20000.f, 1.f, 0.25f),
-                                                            20000.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Low Peak Freq",
-                                                           "Low Peak Freq",
-                                                            juce::NormalisableRange<float>(60.f, 200.f, 1.f, 0.25f),
-                                                            60.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Low Peak Gain",
-                                                           "Low Peak Gain",
-                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                            0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Low Peak Quality",
-                                                           "Low Peak Quality",
-                                                            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                            1.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowMid Peak Freq",
-                                                           "LowMid Peak Freq",
-                                                           juce::NormalisableRange<float>(200.f, 600.f, 1.f, 0.25f),
-                                                           200.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowMid Peak Gain",
-                                                           "LowMid Peak Gain",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowMid Peak Quality",
-                                                           "LowMid Peak Quality",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                           1.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighMid Peak Freq",
-                                                           "HighMid Peak Freq",
-                                                           juce::NormalisableRange<float>(600.f, 3000.f, 1.f, 0.25f),
-                                                           600.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighMid Peak Gain",
-                                                           "HighMid Peak Gain",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighMid Peak Quality",
-                                                           "HighMid Peak Quality",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                           1.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("High Peak Freq",
-                                                           "High Peak Freq",
-                                                           juce::NormalisableRange<float>(3000.f, 8000.f, 1.f, 0.25f),
-                                                           3000.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("High Peak Gain",
-                                                           "High Peak Gain",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("High Peak Quality",
-                                                           "High Peak Quality",
-                                                           juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                           1.f));
-
     juce::StringArray stringArray;
     for (int i = 0; i < 4; ++i) 
     {
@@ -449,16 +613,30 @@ juce::AudioProcessorValueTreeState::ParameterLayout SpectrumEQAudioProcessor::cr
         stringArray.add(str);
     }
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", stringArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
-
-    layout.add(std::make_unique<juce::AudioParameterBool>("LowCut Bypassed", "LowCut Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("Low Peak Bypassed", "Low Peak Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("LowMid Peak Bypassed", "LowMid Peak Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("HighMid Peak Bypassed", "HighMid Peak Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("High Peak Bypassed", "High Peak Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("HighCut Bypassed", "HighCut Bypassed", false));
-    layout.add(std::make_unique<juce::AudioParameterBool>("Analyzer Enabled", "Analyzer Enabled", true));
+    for (const auto& spec : parameterTable)
+    {
+        switch (spec.kind)
+        {
+            case ParameterKind::Float:
+                layout.add(std::make_unique<juce::AudioParameterFloat>(spec.id,
+                                                                       spec.id,
+                                                                       juce::NormalisableRange<float>(spec.minValue, spec.maxValue, spec.interval, spec.skew),
+                                                                       spec.defaultValue));
+                break;
+
+            case ParameterKind::Choice:
+                jassert(spec.role == ParameterRole::Slope || spec.role == ParameterRole::Routing);
+                layout.add(std::make_unique<juce::AudioParameterChoice>(spec.id,
+                                                                        spec.id,
+                                                                        spec.role == ParameterRole::Routing ? getRoutingChoices() : stringArray,
+                                                                        (int)spec.defaultValue));
+                break;
+
+            case ParameterKind::Bool:
+                layout.add(std::make_unique<juce::AudioParameterBool>(spec.id, spec.id, spec.defaultValue > 0.5f));
+                break;
+        }
+    }
 
     return layout;
 }
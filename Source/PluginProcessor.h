@@ -11,9 +11,40 @@
 #include <JuceHeader.h>
 
 #include <array>
-template<typename T>
+
+#include "AnalyzerFrameExport.h"
+#include "AutoGain.h"
+#include "EventTrace.h"
+#include "FilterEngine.h"
+#include "LevelMeter.h"
+enum class FifoOverflow
+{
+    DropNewest,         // a full fifo refuses new values until the consumer catches up
+    OverwriteOldest     // latest wins: a full fifo drops its oldest values, for display pipelines
+};
+
+/*
+ a single producer, single consumer queue of preallocated values that never copies
+ them. there are Capacity + 2 slots: one the producer writes into, one the consumer
+ reads from, and one per queue position. publishing and acquiring exchange a slot
+ index with the queue position, tagged with the push count, so neither side waits
+ and ownership of every slot stays with exactly one of them.
+
+ with OverwriteOldest the producer just exchanges into the oldest position; a
+ consumer that finds a newer value than it expected there takes that one and skips
+ ahead.
+ */
+template<typename T, int Capacity = 30, FifoOverflow overflow = FifoOverflow::DropNewest>
 struct Fifo
 {
+    Fifo()
+    {
+        // every position starts out holding a read slot of its own
+        for (int i = 0; i < Capacity; ++i)
+            positions[(size_t)i].store((juce::uint64)i);
+    }
+
+    // sizes every slot, including the ones the producer and consumer are holding
     void prepare(int numChannels, int numSamples)
     {
         static_assert(std::is_same_v<T, juce::AudioBuffer<float>>,
@@ -42,39 +73,143 @@ struct Fifo
         }
     }
 
-    bool push(const T& t)
+    //==============================================================================
+    // producer side: fill the write slot in place, then publish it
+    T& getWriteSlot() { return buffers[(size_t)writeSlot]; }
+
+    // false if the fifo is full and drops new values; the write slot then keeps its contents
+    bool publish()
     {
-        auto write = fifo.write(1);
-        if (write.blockSize1 > 0)
+        const auto count = numWritten.load(std::memory_order_relaxed);
+
+        if constexpr (overflow == FifoOverflow::DropNewest)
         {
-            buffers[write.startIndex1] = t;
-            return true;
+            if (count - numRead.load(std::memory_order_acquire) >= (juce::uint64)Capacity)
+                return false;
         }
 
-        return false;
+        // whatever comes back, an already read slot or an overwritten one, is free to write into
+        const auto previous = positions[(size_t)(count % Capacity)].exchange(((count + 1) << slotBits) | (juce::uint64)writeSlot,
+                                                                              std::memory_order_acq_rel);
+        writeSlot = (int)(previous & slotMask);
+
+        numWritten.store(count + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool push(const T& t)
+    {
+        getWriteSlot() = t;
+        return publish();
+    }
+
+    //==============================================================================
+    // consumer side: the oldest value still queued, or nullptr. it stays valid until acquire() returns another one
+    const T* acquire()
+    {
+        const auto written = numWritten.load(std::memory_order_acquire);
+        auto next = numRead.load(std::memory_order_relaxed);
+
+        if (written <= next)
+            return nullptr;
+
+        // values the producer has lapped are gone
+        if (written - next > (juce::uint64)Capacity)
+            next = written - Capacity;
+
+        // the position always holds something newer than next by now; if it was lapped again meanwhile, that is taken instead
+        const auto taken = positions[(size_t)(next % Capacity)].exchange((juce::uint64)readSlot, std::memory_order_acq_rel);
+        readSlot = (int)(taken & slotMask);
+
+        const auto takenCount = taken >> slotBits;
+        jassert(takenCount > next);
+
+        numRead.store(takenCount, std::memory_order_release);
+        return &buffers[(size_t)readSlot];
     }
 
     bool pull(T& t)
     {
-        auto read = fifo.read(1);
-        if (read.blockSize1 > 0)
+        if (auto* value = acquire())
         {
-            t = buffers[read.startIndex1];
+            t = *value;
             return true;
         }
 
         return false;
     }
 
+    // an upper bound when called from the producer, exact from the consumer
     int getNumAvailableForReading() const
     {
-        return fifo.getNumReady();
+        const auto written = numWritten.load(std::memory_order_acquire);
+        const auto read = numRead.load(std::memory_order_acquire);
+
+        return written > read ? (int)juce::jmin((juce::uint64)Capacity, written - read) : 0;
+    }
+
+private:
+    // a queue position holds the push count that filled it (0 for a read one) above the slot index
+    static constexpr int slotBits = 8;
+    static constexpr juce::uint64 slotMask = (1 << slotBits) - 1;
+
+    static_assert(Capacity > 0 && Capacity + 2 <= (int)slotMask + 1, "Fifo capacity is limited by the slot bits of a queue position");
+
+    std::array<T, Capacity + 2> buffers;
+
+    std::array<std::atomic<juce::uint64>, Capacity> positions;
+    std::atomic<juce::uint64> numWritten{ 0 }, numRead{ 0 };
+
+    int writeSlot = Capacity;
+    int readSlot = Capacity + 1;
+
+};
+
+/*
+ hands the most recent value from one producer to one consumer without copying it.
+ the three slots are preallocated and change hands by swapping indices, so neither
+ side ever waits and older values are simply overwritten.
+ */
+template<typename T>
+struct TripleBuffer
+{
+    // not thread safe: call it before the producer and consumer start, or from the only thread using it
+    void prepare(size_t numElements, float initialValue)
+    {
+        static_assert(std::is_same_v<T, std::vector<float>>,
+            "prepare(numElements, initialValue) should only be used when the TripleBuffer is holding std::vector<float>");
+
+        for (auto& slot : slots)
+            slot.assign(numElements, initialValue);
+    }
+
+    // producer side
+    T& getWriteBuffer() { return slots[writeIndex]; }
+
+    void publish()
+    {
+        writeIndex = readyState.exchange(writeIndex | newDataFlag) & indexMask;
+    }
+
+    // consumer side
+    bool hasNewData() const { return (readyState.load() & newDataFlag) != 0; }
+
+    const T& acquire()
+    {
+        if (hasNewData())
+            readIndex = readyState.exchange(readIndex) & indexMask;
+
+        return slots[readIndex];
     }
 
 private:
-    static constexpr int Capacity = 30;
-    std::array<T, Capacity> buffers;
-    juce::AbstractFifo fifo{ Capacity };
+    static constexpr int indexMask = 3;
+    static constexpr int newDataFlag = 4;
+
+    std::array<T, 3> slots;
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> readyState{ 2 };
 };
 
 enum Channel
@@ -109,11 +244,6 @@ struct SingleChannelSampleFifo
         prepared.set(false);
         size.set(bufferSize);
 
-        bufferToFill.setSize(1,             //channel
-                             bufferSize,    //num samples
-                             false,         //keepExistingContent
-                             true,          //clear extra space
-                             true);         //avoid reallocating
         audioBufferFifo.prepare(1, bufferSize);
         fifoIndex = 0;
         prepared.set(true);
@@ -122,132 +252,234 @@ struct SingleChannelSampleFifo
     int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading(); }
     bool isPrepared() const { return prepared.get(); }
     int getSize() const { return size.get(); }
+    Channel getChannel() const { return channelToUse; }
     //==============================================================================
-    bool getAudioBuffer(BlockType& buf) { return audioBufferFifo.pull(buf); }
+    // the oldest complete buffer, or nullptr. valid until a later call returns another one
+    const BlockType* getAudioBuffer() { return audioBufferFifo.acquire(); }
 
 private:
     Channel channelToUse;
     int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
+    // samples go straight into the fifo's write slot. after a GUI stall the oldest buffers are dropped, not the newest
+    Fifo<BlockType, 30, FifoOverflow::OverwriteOldest> audioBufferFifo;
     juce::Atomic<bool> prepared = false;
     juce::Atomic<int> size = 0;
 
     void pushNextSampleIntoFifo(float sample)
     {
-        if (fifoIndex == bufferToFill.getNumSamples())
-        {
-            auto ok = audioBufferFifo.push(bufferToFill);
+        auto& bufferToFill = audioBufferFifo.getWriteSlot();
 
-            juce::ignoreUnused(ok);
+        bufferToFill.setSample(0, fifoIndex, sample);
 
+        if (++fifoIndex == bufferToFill.getNumSamples())
+        {
+            audioBufferFifo.publish();
             fifoIndex = 0;
         }
-
-        bufferToFill.setSample(0, fifoIndex, sample);
-        ++fifoIndex;
     }
 };
 
-enum Slope
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
-};
+juce::StringArray getRoutingChoices();
 
-struct ChainSettings
+std::array<BandSpec, numPanelBands> makeDefaultPanelBands();     // at parameterTable's defaults
+
+//==============================================================================
+// every parameter, in the order it is added to the layout (and seen by the host)
+enum ParameterIndex
 {
-    float lowPeakFreq{ 0 }, lowPeakGainInDecibels{ 0 }, lowPeakQuality{ 1.f };
-    float lowMidPeakFreq{ 0 }, lowMidPeakGainInDecibels{ 0 }, lowMidPeakQuality{ 1.f };
-    float highMidPeakFreq{ 0 }, highMidPeakGainInDecibels{ 0 }, highMidPeakQuality{ 1.f };
-    float highPeakFreq{ 0 }, highPeakGainInDecibels{ 0 }, highPeakQuality{ 1.f };
-    float lowCutFreq{ 0 }, highCutFreq{ 0 };
-    
-    Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
-
-    bool lowCutBypassed{ false }, lowPeakBypassed{ false }, lowMidPeakBypassed{ false }, 
-        highMidPeakBypassed{ false }, highPeakBypassed{ false }, highCutBypassed{ false };
+    LowCutFreq,
+    HighCutFreq,
+    LowPeakFreq, LowPeakGain, LowPeakQuality,
+    LowMidPeakFreq, LowMidPeakGain, LowMidPeakQuality,
+    HighMidPeakFreq, HighMidPeakGain, HighMidPeakQuality,
+    HighPeakFreq, HighPeakGain, HighPeakQuality,
+    LowCutSlope, HighCutSlope,
+    LowCutBypassed, LowPeakBypassed, LowMidPeakBypassed, HighMidPeakBypassed, HighPeakBypassed, HighCutBypassed,
+    AnalyzerEnabled,
+    LowPeakThreshold, LowPeakRatio, LowPeakAttack, LowPeakRelease,
+    LowMidPeakThreshold, LowMidPeakRatio, LowMidPeakAttack, LowMidPeakRelease,
+    HighMidPeakThreshold, HighMidPeakRatio, HighMidPeakAttack, HighMidPeakRelease,
+    HighPeakThreshold, HighPeakRatio, HighPeakAttack, HighPeakRelease,
+    LowCutRouting, LowPeakRouting, LowMidPeakRouting, HighMidPeakRouting, HighPeakRouting, HighCutRouting,
+    AutoGainEnabled, AutoGainFreeze,
+    NumParameters
 };
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+enum class ParameterKind { Float, Choice, Bool };
+enum class ParameterRole { Freq, Gain, Quality, Slope, Bypassed, AnalyzerEnabled, Threshold, Ratio, Attack, Release, Routing, AutoGain, AutoGainFreeze };
 
-using Filter = juce::dsp::IIR::Filter<float>;
+constexpr int noBand = -1;
 
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, Filter, Filter, Filter, CutFilter>;
-
-enum ChainPositions
+struct ParameterSpec
 {
-    LowCut,
-    LowPeak,
-    LowMidPeak,
-    HighMidPeak,
-    HighPeak,
-    HighCut
+    const char* id;
+    ParameterKind kind;
+    ParameterRole role;
+    int band;   // PanelBand, or noBand
+    float minValue, maxValue, interval, skew;
+    float defaultValue;
+    const char* unit;
 };
 
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-Coefficients makeLowPeakFilter(const ChainSettings& chainSettings, double sampleRate);
-Coefficients makeLowMidPeakFilter(const ChainSettings& chainSettings, double sampleRate);
-Coefficients makeHighMidPeakFilter(const ChainSettings& chainSettings, double sampleRate);
-Coefficients makeHighPeakFilter(const ChainSettings& chainSettings, double sampleRate);
+/*
+ the single definition of the parameter set: the layout, the cached value handles
+ and the editor's attachments are all generated from this table.
+ */
+inline constexpr std::array<ParameterSpec, NumParameters> parameterTable
+{{
+    { "LowCut Freq",          ParameterKind::Float,  ParameterRole::Freq,     LowCut,      20.f,    60.f,    1.f,   0.25f, 20.f,    "Hz" },
+    { "HighCut Freq",         ParameterKind::Float,  ParameterRole::Freq,     HighCut,     8000.f,  20000.f, 1.f,   0.25f, 20000.f, "Hz" },
+
+    { "Low Peak Freq",        ParameterKind::Float,  ParameterRole::Freq,     LowPeak,     60.f,    200.f,   1.f,   0.25f, 60.f,    "Hz" },
+    { "Low Peak Gain",        ParameterKind::Float,  ParameterRole::Gain,     LowPeak,     -24.f,   24.f,    0.5f,  1.f,   0.f,     "dB" },
+    { "Low Peak Quality",     ParameterKind::Float,  ParameterRole::Quality,  LowPeak,     0.1f,    10.f,    0.05f, 1.f,   1.f,     ""   },
+
+    { "LowMid Peak Freq",     ParameterKind::Float,  ParameterRole::Freq,     LowMidPeak,  200.f,   600.f,   1.f,   0.25f, 200.f,   "Hz" },
+    { "LowMid Peak Gain",     ParameterKind::Float,  ParameterRole::Gain,     LowMidPeak,  -24.f,   24.f,    0.5f,  1.f,   0.f,     "dB" },
+    { "LowMid Peak Quality",  ParameterKind::Float,  ParameterRole::Quality,  LowMidPeak,  0.1f,    10.f,    0.05f, 1.f,   1.f,     ""   },
+
+    { "HighMid Peak Freq",    ParameterKind::Float,  ParameterRole::Freq,     HighMidPeak, 600.f,   3000.f,  1.f,   0.25f, 600.f,   "Hz" },
+    { "HighMid Peak Gain",    ParameterKind::Float,  ParameterRole::Gain,     HighMidPeak, -24.f,   24.f,    0.5f,  1.f,   0.f,     "dB" },
+    { "HighMid Peak Quality", ParameterKind::Float,  ParameterRole::Quality,  HighMidPeak, 0.1f,    10.f,    0.05f, 1.f,   1.f,     ""   },
+
+    { "High Peak Freq",       ParameterKind::Float,  ParameterRole::Freq,     HighPeak,    3000.f,  8000.f,  1.f,   0.25f, 3000.f,  "Hz" },
+    { "High Peak Gain",       ParameterKind::Float,  ParameterRole::Gain,     HighPeak,    -24.f,   24.f,    0.5f,  1.f,   0.f,     "dB" },
+    { "High Peak Quality",    ParameterKind::Float,  ParameterRole::Quality,  HighPeak,    0.1f,    10.f,    0.05f, 1.f,   1.f,     ""   },
+
+    { "LowCut Slope",         ParameterKind::Choice, ParameterRole::Slope,    LowCut,      0.f,     3.f,     1.f,   1.f,   0.f,     "dB/Oct" },
+    { "HighCut Slope",        ParameterKind::Choice, ParameterRole::Slope,    HighCut,     0.f,     3.f,     1.f,   1.f,   0.f,     "dB/Oct" },
+
+    { "LowCut Bypassed",      ParameterKind::Bool,   ParameterRole::Bypassed, LowCut,      0.f,     1.f,     1.f,   1.f,   0.f,     ""   },
+    { "Low Peak Bypassed",    ParameterKind::Bool,   ParameterRole::Bypassed, LowPeak,     0.f,     1.f,     1.f,   1.f,   0.f,     ""   },
+    { "LowMid Peak Bypassed", ParameterKind::Bool,   ParameterRole::Bypassed, LowMidPeak,  0.f,     1.f,     1.f,   1.f,   0.f,     ""   },
+    { "HighMid Peak Bypassed",ParameterKind::Bool,   ParameterRole::Bypassed, HighMidPeak, 0.f,     1.f,     1.f,   1.f,   0.f,     ""   },
+    { "High Peak Bypassed",   ParameterKind::Bool,   ParameterRole::Bypassed, HighPeak,    0.f,     1.f,     1.f,   1.f,   0.f,     ""   },
+    { "HighCut Bypassed",     ParameterKind::Bool,   ParameterRole::Bypassed, HighCut,     0.f,     1.f,     1.f,   1.f,   0.f,     ""   },
+
+    { "Analyzer Enabled",     ParameterKind::Bool,   ParameterRole::AnalyzerEnabled, noBand, 0.f,   1.f,     1.f,   1.f,   1.f,     ""   },
+
+    // dynamic eq, appended so the original parameters keep their host indices. a ratio of 1:1 keeps a band static
+    { "Low Peak Threshold",    ParameterKind::Float,  ParameterRole::Threshold, LowPeak,     -60.f,   0.f,     0.5f,  1.f,   0.f,     "dB" },
+    { "Low Peak Ratio",        ParameterKind::Float,  ParameterRole::Ratio,    LowPeak,     1.f,     10.f,    0.1f,  0.5f,  1.f,     ":1" },
+    { "Low Peak Attack",       ParameterKind::Float,  ParameterRole::Attack,   LowPeak,     0.1f,    100.f,   0.1f,  0.3f,  5.f,     "ms" },
+    { "Low Peak Release",      ParameterKind::Float,  ParameterRole::Release,  LowPeak,     5.f,     1000.f,  1.f,   0.3f,  100.f,   "ms" },
+
+    { "LowMid Peak Threshold", ParameterKind::Float,  ParameterRole::Threshold, LowMidPeak,  -60.f,   0.f,     0.5f,  1.f,   0.f,     "dB" },
+    { "LowMid Peak Ratio",     ParameterKind::Float,  ParameterRole::Ratio,    LowMidPeak,  1.f,     10.f,    0.1f,  0.5f,  1.f,     ":1" },
+    { "LowMid Peak Attack",    ParameterKind::Float,  ParameterRole::Attack,   LowMidPeak,  0.1f,    100.f,   0.1f,  0.3f,  5.f,     "ms" },
+    { "LowMid Peak Release",   ParameterKind::Float,  ParameterRole::Release,  LowMidPeak,  5.f,     1000.f,  1.f,   0.3f,  100.f,   "ms" },
+
+    { "HighMid Peak Threshold", ParameterKind::Float,  ParameterRole::Threshold, HighMidPeak, -60.f,   0.f,     0.5f,  1.f,   0.f,     "dB" },
+    { "HighMid Peak Ratio",    ParameterKind::Float,  ParameterRole::Ratio,    HighMidPeak, 1.f,     10.f,    0.1f,  0.5f,  1.f,     ":1" },
+    { "HighMid Peak Attack",   ParameterKind::Float,  ParameterRole::Attack,   HighMidPeak, 0.1f,    100.f,   0.1f,  0.3f,  5.f,     "ms" },
+    { "HighMid Peak Release",  ParameterKind::Float,  ParameterRole::Release,  HighMidPeak, 5.f,     1000.f,  1.f,   0.3f,  100.f,   "ms" },
+
+    { "High Peak Threshold",   ParameterKind::Float,  ParameterRole::Threshold, HighPeak,    -60.f,   0.f,     0.5f,  1.f,   0.f,     "dB" },
+    { "High Peak Ratio",       ParameterKind::Float,  ParameterRole::Ratio,    HighPeak,    1.f,     10.f,    0.1f,  0.5f,  1.f,     ":1" },
+    { "High Peak Attack",      ParameterKind::Float,  ParameterRole::Attack,   HighPeak,    0.1f,    100.f,   0.1f,  0.3f,  5.f,     "ms" },
+    { "High Peak Release",     ParameterKind::Float,  ParameterRole::Release,  HighPeak,    5.f,     1000.f,  1.f,   0.3f,  100.f,   "ms" },
+
+    // BandRouting, Stereo by default
+    { "LowCut Routing",        ParameterKind::Choice, ParameterRole::Routing,  LowCut,      0.f,     4.f,     1.f,   1.f,   0.f,     ""   },
+    { "Low Peak Routing",      ParameterKind::Choice, ParameterRole::Routing,  LowPeak,     0.f,     4.f,     1.f,   1.f,   0.f,     ""   },
+    { "LowMid Peak Routing",   ParameterKind::Choice, ParameterRole::Routing,  LowMidPeak,  0.f,     4.f,     1.f,   1.f,   0.f,     ""   },
+    { "HighMid Peak Routing",  ParameterKind::Choice, ParameterRole::Routing,  HighMidPeak, 0.f,     4.f,     1.f,   1.f,   0.f,     ""   },
+    { "High Peak Routing",     ParameterKind::Choice, ParameterRole::Routing,  HighPeak,    0.f,     4.f,     1.f,   1.f,   0.f,     ""   },
+    { "HighCut Routing",       ParameterKind::Choice, ParameterRole::Routing,  HighCut,     0.f,     4.f,     1.f,   1.f,   0.f,     ""   },
+
+    { "Auto Gain",             ParameterKind::Bool,   ParameterRole::AutoGain, noBand,      0.f,     1.f,     1.f,   1.f,   0.f,     ""   },
+    { "Auto Gain Freeze",      ParameterKind::Bool,   ParameterRole::AutoGainFreeze, noBand, 0.f,    1.f,     1.f,   1.f,   0.f,     ""   },
+}};
+
+static_assert(parameterTable[NumParameters - 1].id != nullptr, "every ParameterIndex needs a row in parameterTable");
 
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
-{
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
-
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& chain,
-    const CoefficientType& coefficients,
-    const Slope& slope)
+/*
+ the raw value of every parameter, looked up once at construction.
+ reading one is a single atomic load: no hashing, no string compares.
+ */
+struct ParameterHandles
 {
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
-
-    switch (slope)
+    explicit ParameterHandles(juce::AudioProcessorValueTreeState& apvts)
     {
-        case Slope_48:
+        for (size_t i = 0; i < parameterTable.size(); ++i)
         {
-            update<3>(chain, coefficients);
-        }
-        case Slope_36:
-        {
-            update<2>(chain, coefficients);
-        }
-        case Slope_24:
-        {
-            update<1>(chain, coefficients);
-        }
-        case Slope_12:
-        {
-            update<0>(chain, coefficients);
+            values[i] = apvts.getRawParameterValue(parameterTable[i].id);
+            jassert(values[i] != nullptr);
         }
     }
-}
 
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-                                                                                       sampleRate,
-                                                                                       2 * (chainSettings.lowCutSlope + 1));
-}
+    float get(ParameterIndex index) const { return values[index]->load(); }
+    bool getBool(ParameterIndex index) const { return get(index) > 0.5f; }
+
+private:
+    std::array<std::atomic<float>*, NumParameters> values{};
+};
+
+ChainSettings getChainSettings(const ParameterHandles& handles);
 
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+/*
+ in-memory preset slots. every entry stores the normalised parameter values and
+ the coefficients for each supported sample rate, so recalling one is a pointer
+ handed to the audio thread.
+
+ compact binary state (little endian):
+     uint32  magic 'SEQB'
+     uint16  version (2)
+     uint16  numValues
+     numValues x { paramID as zero-terminated UTF-8, float normalised value }
+
+ version 1 keyed the values on paramID.hashCode() instead, and is still read.
+ */
+struct PresetBank
 {
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-                                                                                      sampleRate,
-                                                                                      2 * (chainSettings.highCutSlope + 1));
-}
+    static constexpr int numSlots = 8;
+    static constexpr std::array<double, 6> supportedSampleRates{ 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+
+    struct Entry
+    {
+        juce::String name;
+        std::vector<float> values;   // normalised, in getParameters() order
+        std::vector<ChainCoefficients> coefficientSets;
+
+        const ChainCoefficients* findCoefficients(double sampleRate) const;
+    };
+
+    // message thread only
+    void store(int slot, juce::AudioProcessor& processor, const ChainSettings& chainSettings, double currentSampleRate);
+    const Entry* getEntry(int slot) const;
+
+    // the filled slots, in slot order, are what the host sees as programs
+    int getNumFilledSlots() const;
+    int getFilledSlot(int index) const;         // -1 if there aren't that many
+    int getFilledIndex(int slot) const;         // -1 if the slot is empty
+
+    /*
+     message thread. frees the entries store() replaced once the audio thread can't be
+     using them any more: 'pending' (the recall not yet taken) no longer points at them,
+     and the audio thread has since finished the block that may have taken them.
+     load 'pending' before 'blocksCompleted'
+     */
+    void freeReplacedEntries(const Entry* pending, juce::uint32 blocksCompleted);
+
+    static void writeState(juce::AudioProcessor& processor, juce::MemoryBlock& destData);
+    static bool readState(const void* data, int sizeInBytes, juce::AudioProcessor& processor, std::vector<float>& values);
+
+private:
+    static constexpr juce::uint32 stateMagic = 0x42514553; // "SEQB"
+    static constexpr int stateVersion = 2;
+    static constexpr int hashedStateVersion = 1;
+
+    std::array<std::unique_ptr<Entry>, numSlots> slots;
+
+    struct ReplacedEntry
+    {
+        std::unique_ptr<Entry> entry;
+        bool released = false;                  // seen not pending
+        juce::uint32 blocksWhenReleased = 0;
+    };
+
+    std::vector<ReplacedEntry> replacedEntries;
+};
 
 //==============================================================================
 /**
@@ -294,22 +526,51 @@ public:
 
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
+    const ParameterHandles parameterHandles{ apvts };
+
+    // message thread only
+    void storePreset(int slot);
+    void recallPreset(int slot);
+    bool isPresetStored(int slot) const { return presetBank.getEntry(slot) != nullptr; }
+
+    // the slot last stored or recalled, by the editor or by the host through setCurrentProgram(). -1 before either
+    int getCurrentPresetSlot() const { return currentSlot; }
+
+    // sent whenever the current slot is stored or recalled; listeners hear about it asynchronously
+    juce::ChangeBroadcaster presetChanges;
 
     using BlockType = juce::AudioBuffer<float>;
     SingleChannelSampleFifo<BlockType> leftChannelFifo{ Channel::Left };
     SingleChannelSampleFifo<BlockType> rightChannelFifo{ Channel::Right };
 
+    // input and output levels, for the editor or anything else that wants them
+    LevelMeterSource levelMeters;
+
+    // the output's spectra for QA tools, see AnalyzerFrameExportTap. null unless switched on
+    const std::unique_ptr<AnalyzerFrameExportTap> frameExportTap = AnalyzerFrameExportTap::createFromEnvironment();
+
 private:
-    MonoChain leftChain, rightChain;
+    FilterEngine filterEngine;
+
+    AutoGain autoGain;
+    bool autoGainWasEnabled = false;
+
+    std::array<BlockLevels, numMeterChannels> blockLevels;
+    void measureBlockLevels(const juce::AudioBuffer<float>& buffer, int firstMeter);
+
+    PresetBank presetBank;
+    int currentSlot = -1;
+
+    std::atomic<const PresetBank::Entry*> pendingPresetRecall{ nullptr };
+
+    // counts blocks past the point where processBlock lets go of a recalled entry
+    std::atomic<juce::uint32> blocksCompleted{ 0 };
 
-    void updateLowPeakFilter(const ChainSettings& chainSettings);
-    void updateLowMidPeakFilter(const ChainSettings& chainSettings);
-    void updateHighMidPeakFilter(const ChainSettings& chainSettings);
-    void updateHighPeakFilter(const ChainSettings& chainSettings);
-    void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    // odd while the message thread is rewriting parameters in bulk (preset recall, state restore)
+    std::atomic<juce::uint32> parameterWriteSequence{ 0 };
 
-    void updateFilters();
+    void applyParameterValues(const std::vector<float>& values, const PresetBank::Entry* preset);
+    void freeReplacedPresets();
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumEQAudioProcessor)
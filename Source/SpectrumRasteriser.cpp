@@ -0,0 +1,240 @@
+/*
+  ==============================================================================
+
+    SpectrumRasteriser.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumRasteriser.h"
+
+void SpectrumRasteriser::prepare(int width, int height, float newScale)
+{
+    using namespace juce;
+
+    width = jmax(1, width);
+    height = jmax(1, height);
+
+    if (image.isValid() && width == logicalWidth && height == logicalHeight && newScale == scale)
+        return;
+
+    logicalWidth = width;
+    logicalHeight = height;
+    scale = newScale;
+
+    // a software image, so the spans are written straight into its memory
+    image = Image(Image::ARGB, roundToInt(width * scale), roundToInt(height * scale), true, SoftwareImageType());
+
+    dirtySpans.assign((size_t)image.getWidth(), {});
+    fillRows.clear();
+}
+
+void SpectrumRasteriser::clear()
+{
+    if (!image.isValid())
+        return;
+
+    juce::Image::BitmapData pixels(image, juce::Image::BitmapData::writeOnly);
+
+    for (int x = 0; x < pixels.width; ++x)
+    {
+        auto& span = dirtySpans[(size_t)x];
+
+        if (span.bottom > span.top)
+        {
+            auto* pixel = pixels.getPixelPointer(x, span.top);
+
+            for (int y = span.top; y < span.bottom; ++y, pixel += pixels.lineStride)
+                reinterpret_cast<juce::PixelARGB*>(pixel)->setARGB(0, 0, 0, 0);
+        }
+
+        span = {};
+    }
+}
+
+void SpectrumRasteriser::buildFillRows(const Style& style)
+{
+    if (fillRows.size() == (size_t)image.getHeight() && style.fillTop == fillRowsTop && style.fillBottom == fillRowsBottom)
+        return;
+
+    fillRowsTop = style.fillTop;
+    fillRowsBottom = style.fillBottom;
+    fillRows.resize((size_t)image.getHeight());
+
+    for (size_t y = 0; y < fillRows.size(); ++y)
+    {
+        const auto proportion = fillRows.size() > 1 ? (float)y / (float)(fillRows.size() - 1) : 0.f;
+        fillRows[y] = style.fillTop.interpolatedWith(style.fillBottom, proportion).getPixelARGB();
+    }
+}
+
+void SpectrumRasteriser::draw(const std::vector<float>& ys, const Style& style)
+{
+    using namespace juce;
+
+    if (!image.isValid() || ys.empty())
+        return;
+
+    if (style.fill)
+        buildFillRows(style);
+
+    Image::BitmapData pixels(image, Image::BitmapData::readWrite);
+
+    const auto height = pixels.height;
+    const auto lastColumn = (int)ys.size() - 1;
+    const auto halfThickness = 0.5f * style.lineThickness * scale;
+    const auto line = style.lineColour.getPixelARGB();
+
+    // the curve's physical height at logical x, straight lines between the columns like the path had
+    auto curveAt = [&](float x)
+    {
+        const auto clamped = jlimit(0.f, (float)lastColumn, x);
+        const auto column = jmin((int)clamped, jmax(0, lastColumn - 1));
+        const auto t = clamped - (float)column;
+        const auto y0 = ys[(size_t)column];
+        const auto y1 = ys[(size_t)jmin(column + 1, lastColumn)];
+
+        return (y0 + t * (y1 - y0)) * scale;
+    };
+
+    // blends colour over rows [top, bottom), with partial coverage for the fractional first and last row
+    auto fillSpan = [&](int x, float top, float bottom, const PixelARGB* colours, const PixelARGB& colour)
+    {
+        top = jmax(0.f, top);
+        bottom = jmin((float)height, bottom);
+
+        if (bottom <= top)
+            return;
+
+        const auto firstRow = (int)top;
+        const auto lastRow = jmin(height - 1, (int)std::ceil(bottom) - 1);
+
+        auto* pixel = pixels.getPixelPointer(x, firstRow);
+
+        for (int y = firstRow; y <= lastRow; ++y, pixel += pixels.lineStride)
+        {
+            const auto& source = colours != nullptr ? colours[y] : colour;
+            const auto coverage = jmin((float)(y + 1), bottom) - jmax((float)y, top);
+
+            if (coverage >= 1.f)
+                reinterpret_cast<PixelARGB*>(pixel)->blend(source);
+            else
+                reinterpret_cast<PixelARGB*>(pixel)->blend(source, (uint32)roundToInt(coverage * 255.f));
+        }
+
+        auto& span = dirtySpans[(size_t)x];
+
+        if (span.bottom <= span.top)
+            span = { firstRow, lastRow + 1 };
+        else
+            span = { jmin(span.top, firstRow), jmax(span.bottom, lastRow + 1) };
+    };
+
+    for (int x = 0; x < pixels.width; ++x)
+    {
+        // the curve at the column's left and right edges; vertex n sits at logical x = n, as it did in the path
+        const auto left = curveAt((float)x / scale);
+        const auto right = curveAt((float)(x + 1) / scale);
+
+        if (style.fill)
+            fillSpan(x, 0.5f * (left + right), (float)height, fillRows.data(), {});
+
+        fillSpan(x, jmin(left, right) - halfThickness, jmax(left, right) + halfThickness, nullptr, line);
+    }
+}
+
+//==============================================================================
+SpectrumRasteriser::BenchmarkResult SpectrumRasteriser::benchmark(int width, int height, float benchmarkScale, int numFrames)
+{
+    using namespace juce;
+
+    // two random-walk curves, redrawn with fresh noise every frame like a live analyzer
+    Random random(1);
+    std::vector<float> left((size_t)width), right((size_t)width);
+
+    auto makeCurves = [&]()
+    {
+        auto yl = height * 0.5f, yr = height * 0.6f;
+
+        for (int x = 0; x < width; ++x)
+        {
+            yl = jlimit(0.f, (float)height, yl + (random.nextFloat() - 0.5f) * 12.f);
+            yr = jlimit(0.f, (float)height, yr + (random.nextFloat() - 0.5f) * 12.f);
+            left[(size_t)x] = yl;
+            right[(size_t)x] = yr;
+        }
+    };
+
+    BenchmarkResult result;
+
+    // both ways end up drawn into a target like the component's, the raster image by compositing it
+    Image target(Image::ARGB, roundToInt(width * benchmarkScale), roundToInt(height * benchmarkScale), true, SoftwareImageType());
+
+    {
+        SpectrumRasteriser rasteriser;
+        rasteriser.prepare(width, height, benchmarkScale);
+
+        Style leftStyle, rightStyle;
+        leftStyle.lineColour = Colour(97u, 18u, 167u);
+        rightStyle.lineColour = Colour(215u, 201u, 134u);
+
+        double ms = 0.0;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            makeCurves();
+
+            const auto start = Time::getHighResolutionTicks();
+
+            rasteriser.clear();
+            rasteriser.draw(left, leftStyle);
+            rasteriser.draw(right, rightStyle);
+
+            Graphics g(target);
+            g.drawImageAt(rasteriser.getImage(), 0, 0);
+
+            ms += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start) * 1000.0;
+        }
+
+        result.rasterMsPerFrame = ms / numFrames;
+    }
+
+    {
+        Path leftPath, rightPath;
+
+        double ms = 0.0;
+
+        for (int frame = 0; frame < numFrames; ++frame)
+        {
+            makeCurves();
+
+            const auto start = Time::getHighResolutionTicks();
+
+            // what paint() did before: build both paths, then stroke them
+            for (auto* curve : { &left, &right })
+            {
+                auto& path = curve == &left ? leftPath : rightPath;
+
+                path.clear();
+                path.startNewSubPath(0.f, (*curve)[0]);
+
+                for (int x = 1; x < width; ++x)
+                    path.lineTo((float)x, (*curve)[(size_t)x]);
+            }
+
+            Graphics g(target);
+            g.addTransform(AffineTransform::scale(benchmarkScale));
+
+            g.setColour(Colour(97u, 18u, 167u));
+            g.strokePath(leftPath, PathStrokeType(1.f));
+            g.setColour(Colour(215u, 201u, 134u));
+            g.strokePath(rightPath, PathStrokeType(1.f));
+
+            ms += Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start) * 1000.0;
+        }
+
+        result.strokePathMsPerFrame = ms / numFrames;
+    }
+
+    return result;
+}
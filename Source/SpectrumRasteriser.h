@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    SpectrumRasteriser.h
+
+    Draws analyzer curves straight into an image, one vertical span per pixel
+    column, instead of stroking them as paths.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <vector>
+
+/*
+ an analyzer curve has exactly one y per pixel column, so it doesn't need a path
+ renderer: per physical column the line is the span between the curve's heights
+ at the column's two edges, widened by the thickness, with fractional coverage at
+ both ends. the fill under it is a span down to the bottom, coloured from a per-row
+ gradient table.
+
+ the image is kept at physical resolution and only the spans drawn last frame are
+ cleared, so a frame costs about the pixels the curves touch.
+ */
+struct SpectrumRasteriser
+{
+    struct Style
+    {
+        juce::Colour lineColour;
+        float lineThickness = 1.f;      // logical pixels
+
+        bool fill = false;
+        juce::Colour fillTop, fillBottom;
+    };
+
+    // width and height in logical pixels. keeps the image when nothing changed
+    void prepare(int width, int height, float scale);
+
+    // takes out everything drawn since the last clear()
+    void clear();
+
+    // one y per logical column relative to the top, as AnalyzerRenderDataGenerator makes them
+    void draw(const std::vector<float>& ys, const Style& style);
+
+    const juce::Image& getImage() const { return image; }
+
+    struct BenchmarkResult
+    {
+        double rasterMsPerFrame = 0.0;
+        double strokePathMsPerFrame = 0.0;
+    };
+
+    /*
+     two fresh curves per frame, drawn both ways into a software image of the same physical
+     size: rasterised and composited, or built as paths and stroked as paint() does without
+     the rasteriser. the console tool runs it with "raster"
+     */
+    static BenchmarkResult benchmark(int width, int height, float scale, int numFrames);
+
+private:
+    juce::Image image;
+    int logicalWidth = 0, logicalHeight = 0;
+    float scale = 1.f;
+
+    // rows [top, bottom) each physical column has pixels in since the last clear()
+    struct Span
+    {
+        int top = 0, bottom = 0;
+    };
+
+    std::vector<Span> dirtySpans;
+
+    std::vector<juce::PixelARGB> fillRows;
+    juce::Colour fillRowsTop, fillRowsBottom;
+
+    void buildFillRows(const Style& style);
+};